@@ -1,5 +1,8 @@
 CC      = clang
 CFLAGS  = -std=c99 -Os -Wall -pedantic -fPIC
+LDLIBS  = -lpthread
+# uncomment to build the SSE2/AVX2/AVX-512 bit-row kernels for the host CPU
+#CFLAGS += -march=native
 MAKE    = make
 DOXYGEN = doxygen
 
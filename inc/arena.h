@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Region allocator.
+
+ An arena hands out memory from large chunks and frees all of it at once with
+ rf_arena_clear or rf_arena_free. The _in constructors of rf_Set, rf_SetElement and
+ rf_Relation build their objects in an arena. Freeing such an object on its own does
+ nothing. Resources the arena does not own, such as atom references and caches, are
+ released through rf_arena_defer when the arena is cleared. The _in constructors
+ return NULL if there is no memory for the object or for noting its release.
+
+ An arena must not be used by two threads at once. Objects in it must not be used
+ after it is cleared.
+ */
+
+#ifndef RF_ARENA_H
+#define RF_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct _rf_arena rf_Arena;
+
+rf_Arena *      rf_arena_new(void);
+void *          rf_arena_alloc(rf_Arena *arena, size_t size);
+bool            rf_arena_defer(rf_Arena *arena, void (*release)(void *object), void *object);
+size_t          rf_arena_size(const rf_Arena *arena);
+void            rf_arena_clear(rf_Arena *arena);
+void            rf_arena_free(rf_Arena *arena);
+
+#endif
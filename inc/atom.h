@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Interned strings.
+
+ The atom table keeps one copy of every distinct string in use. rf_atom_intern
+ returns that copy, so two atoms are equal exactly if they are the same pointer.
+ Each atom carries its hash and an id that stays fixed while it lives, and is freed
+ when its last reference is released. rf_atom_intern_bytes makes atoms of any
+ bytes; rf_Set identifies the values of nested sets with them.
+
+ The table is shared by all threads. Interning and releasing take a lock,
+ rf_atom_acquire only touches the reference count of an atom already held.
+ Atoms are read-only.
+ */
+
+#ifndef RF_ATOM_H
+#define RF_ATOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+const char *            rf_atom_intern(const char *string);
+const char *            rf_atom_intern_bytes(const void *bytes, size_t length);
+const char *            rf_atom_acquire(const char *atom);
+void                    rf_atom_release(const char *atom);
+
+uint64_t                rf_atom_hash(const char *atom);
+unsigned int            rf_atom_id(const char *atom);
+size_t                  rf_atom_count(void);
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Boolean matrix kernels.
+
+ A bit matrix is a row-major array of bit rows (see bitrow.h): row i starts at word
+ i * stride. These kernels work on the tables of rf_Relation but know nothing
+ about domains.
+ */
+
+#ifndef RF_BITMATRIX_H
+#define RF_BITMATRIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+bool            rf_bitmatrix_product(uint64_t *c, size_t c_stride,
+                                     const uint64_t *a, size_t a_stride,
+                                     const uint64_t *b, size_t b_stride,
+                                     size_t n, size_t k, size_t m);
+void            rf_bitmatrix_transpose(uint64_t *dst, size_t dst_stride,
+                                       const uint64_t *src, size_t src_stride,
+                                       size_t n, size_t m);
+void            rf_bitmatrix_transpose_square(uint64_t *a, size_t stride, size_t n);
+void            rf_bitmatrix_closure(uint64_t *a, size_t stride, size_t n);
+
+#endif
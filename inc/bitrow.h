@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Bit rows.
+
+ A bit row is an array of 64-bit words holding one bit per element. Bit i lives in
+ word i / 64 at position i % 64. Rows are padded to whole cache lines and allocated
+ cache-line aligned, so every row of a table starts on its own line and word-wise
+ kernels never need to handle a partial line. Padding bits are always zero.
+
+ The word-wise kernels use AVX-512, AVX2 or SSE2 when the compiler targets them
+ (e.g. -march=native in config.mk) and plain 64-bit words otherwise. dst may alias
+ either operand.
+ */
+
+#ifndef RF_BITROW_H
+#define RF_BITROW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RF_BITROW_WORD_BITS     64
+#define RF_BITROW_LINE_WORDS    8       /*!< Words per 64 byte cache line */
+#define RF_BITROW_NONE          ((size_t) -1)   /*!< No such bit */
+
+size_t          rf_bitrow_words(size_t nbits);
+
+static inline unsigned int
+rf_bitrow_popcount(uint64_t w) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(w);
+#else
+        w = w - ((w >> 1) & UINT64_C(0x5555555555555555));
+        w = (w & UINT64_C(0x3333333333333333)) + ((w >> 2) & UINT64_C(0x3333333333333333));
+        w = (w + (w >> 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+        return (w * UINT64_C(0x0101010101010101)) >> 56;
+#endif
+}
+
+/*
+ * Index of the lowest set bit, w must not be 0.
+ */
+static inline unsigned int
+rf_bitrow_ctz(uint64_t w) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(w);
+#else
+        return rf_bitrow_popcount((w & -w) - 1);
+#endif
+}
+
+/*
+ * Index of the highest set bit, w must not be 0.
+ */
+static inline unsigned int
+rf_bitrow_msb(uint64_t w) {
+#if defined(__GNUC__)
+        return RF_BITROW_WORD_BITS - 1 - __builtin_clzll(w);
+#else
+        unsigned int i = 0;
+        while(w >>= 1)
+                i++;
+        return i;
+#endif
+}
+
+static inline bool
+rf_bitrow_get(const uint64_t *row, size_t i) {
+        return (row[i / RF_BITROW_WORD_BITS] >> (i % RF_BITROW_WORD_BITS)) & 1;
+}
+
+static inline void
+rf_bitrow_set(uint64_t *row, size_t i) {
+        row[i / RF_BITROW_WORD_BITS] |= UINT64_C(1) << (i % RF_BITROW_WORD_BITS);
+}
+
+static inline void
+rf_bitrow_clear(uint64_t *row, size_t i) {
+        row[i / RF_BITROW_WORD_BITS] &= ~(UINT64_C(1) << (i % RF_BITROW_WORD_BITS));
+}
+
+uint64_t *      rf_bitrow_alloc(size_t nwords);
+void            rf_bitrow_free(uint64_t *row);
+
+void            rf_bitrow_set_all(uint64_t *row, size_t nbits);
+void            rf_bitrow_not(uint64_t *row, size_t nbits);
+size_t          rf_bitrow_count(const uint64_t *row, size_t nwords);
+size_t          rf_bitrow_first_andnot(const uint64_t *a, const uint64_t *b, size_t nwords);
+size_t          rf_bitrow_first(const uint64_t *row, size_t nwords);
+size_t          rf_bitrow_last(const uint64_t *row, size_t nwords);
+uint64_t        rf_bitrow_hash(const uint64_t *row, size_t nwords);
+void            rf_bitrow_accumulate(uint64_t *seen, uint64_t *twice, const uint64_t *row, size_t nwords);
+
+void            rf_bitrow_or(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords);
+void            rf_bitrow_and(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords);
+void            rf_bitrow_andnot(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords);
+
+#endif
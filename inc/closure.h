@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Incrementally maintained transitive closures.
+
+ rf_Closure holds the transitive closure of a homogeneous relation and keeps it
+ closed while pairs are added, without recomputing it from scratch. A single pair
+ is propagated right away; pairs added with rf_closure_defer are collected and
+ propagated together by rf_closure_flush.
+ */
+
+#ifndef RF_CLOSURE_H
+#define RF_CLOSURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "error.h"
+#include "relation.h"
+
+typedef struct _rf_closure rf_Closure;
+
+struct _rf_closure {
+        rf_Relation   *relation;        /*!< Transitively closed whenever nothing is pending */
+        int           *pending;         /*!< Deferred pairs, x and y interleaved */
+        size_t        n_pending;        /*!< Number of deferred pairs */
+        size_t        capacity;         /*!< Pairs pending has room for */
+};
+
+rf_Closure *            rf_closure_new(const rf_Relation *relation, rf_Error *error);
+
+bool                    rf_closure_insert(rf_Closure *closure, int x, int y);
+bool                    rf_closure_defer(rf_Closure *closure, int x, int y, rf_Error *error);
+void                    rf_closure_flush(rf_Closure *closure);
+
+bool                    rf_closure_get(const rf_Closure *closure, int x, int y);
+const rf_Relation *     rf_closure_get_relation(rf_Closure *closure);
+
+void                    rf_closure_free(rf_Closure *closure);
+
+#endif
@@ -36,6 +36,7 @@ enum _rf_errorcode {
 	RF_E_REL_NO_MAX,
 	RF_E_REL_NOT_HOMOGENEOUS,
 	RF_E_REL_NOT_ORDERED,
+	RF_E_REL_NOT_LATTICE,
 };
 
 typedef struct _rf_error        rf_Error;
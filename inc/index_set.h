@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Sets of element indices.
+
+ rf_IndexSet is a subset of a domain given by the indices of its members, one bit
+ each, laid out like a row of a relation. Queries on relations take and return
+ them to work on whole words; rf_index_set_new_from_set and rf_index_set_to_set
+ translate from and to the rf_Set of the domain.
+ */
+
+#ifndef RF_INDEX_SET_H
+#define RF_INDEX_SET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "set.h"
+#include "error.h"
+#include "bitrow.h"
+
+typedef struct _rf_index_set rf_IndexSet;
+
+struct _rf_index_set {
+        int           capacity;         /*!< Members range over 0 .. capacity - 1 */
+        size_t        words;            /*!< rf_bitrow_words(capacity) */
+        uint64_t      *bits;            /*!< Bit i is set for member i, padding bits are 0 */
+};
+
+static inline bool
+rf_index_set_contains(const rf_IndexSet *s, int i) {
+        assert(i >= 0 && i < s->capacity);
+        return rf_bitrow_get(s->bits, i);
+}
+
+static inline void
+rf_index_set_add(rf_IndexSet *s, int i) {
+        assert(i >= 0 && i < s->capacity);
+        rf_bitrow_set(s->bits, i);
+}
+
+static inline void
+rf_index_set_remove(rf_IndexSet *s, int i) {
+        assert(i >= 0 && i < s->capacity);
+        rf_bitrow_clear(s->bits, i);
+}
+
+rf_IndexSet *           rf_index_set_new(int capacity);
+rf_IndexSet *           rf_index_set_new_full(int capacity);
+rf_IndexSet *           rf_index_set_new_from_set(const rf_Set *subset, const rf_Set *domain, rf_Error *error);
+rf_IndexSet *           rf_index_set_clone(const rf_IndexSet *set);
+
+void                    rf_index_set_clear(rf_IndexSet *set);
+int                     rf_index_set_add_set(rf_IndexSet *set, const rf_Set *subset, const rf_Set *domain);
+
+int                     rf_index_set_count(const rf_IndexSet *set);
+int                     rf_index_set_next(const rf_IndexSet *set, int from);
+rf_Set *                rf_index_set_to_set(const rf_IndexSet *set, const rf_Set *domain);
+
+void                    rf_index_set_free(rf_IndexSet *set);
+
+#endif
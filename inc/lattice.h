@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Lattices.
+
+ rf_Lattice answers joins and meets of a lattice given as a partial order. Up to
+ RF_LATTICE_TABLE_MAX elements both operations are tabulated once, n^2 entries of
+ two bytes each, and a query is a single lookup. Larger lattices answer from the
+ bit rows of their rf_Poset, O(n / 64) per query. Neither allocates, so the join or
+ meet of k elements folds in k - 1 queries.
+
+ Elements are the indices into the domain of the relation. Queries without tables
+ share the scratch row of the poset, see poset.h.
+ */
+
+#ifndef RF_LATTICE_H
+#define RF_LATTICE_H
+
+#include <stdint.h>
+
+#include "error.h"
+#include "relation.h"
+#include "poset.h"
+
+#define RF_LATTICE_TABLE_MAX 2048       /*!< Largest lattice whose join and meet get tabulated */
+
+typedef struct _rf_lattice rf_Lattice;
+
+struct _rf_lattice {
+        int           n;
+        int           top;              /*!< Greatest element, -1 if empty */
+        int           bottom;           /*!< Least element, -1 if empty */
+        rf_Poset      *poset;
+        uint16_t      *join;            /*!< join[x * n + y], NULL above RF_LATTICE_TABLE_MAX */
+        uint16_t      *meet;            /*!< meet[x * n + y], NULL above RF_LATTICE_TABLE_MAX */
+};
+
+rf_Lattice *            rf_lattice_new(const rf_Relation *relation, rf_Error *error);
+
+int                     rf_lattice_join(const rf_Lattice *lattice, int x, int y);
+int                     rf_lattice_meet(const rf_Lattice *lattice, int x, int y);
+int                     rf_lattice_join_all(const rf_Lattice *lattice, int count, const int *elements);
+int                     rf_lattice_meet_all(const rf_Lattice *lattice, int count, const int *elements);
+
+void                    rf_lattice_free(rf_Lattice *lattice);
+
+#endif
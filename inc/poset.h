@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Partial orders.
+
+ rf_Poset prepares a partial order R for bound queries. As everywhere in RelaFix,
+ xRy reads "x is above y": the down-set of x is row x, its up-set column x.
+
+ Elements are renumbered along a linear extension, smaller elements first, and both
+ sets are kept as bit rows over these positions. The least element of any up-set
+ intersection then is the one at its lowest position, the greatest of a down-set
+ intersection the one at its highest, so a join or meet takes one AND, one bit scan
+ and one subset test, O(n / 64). Queries work in a scratch row of the poset and
+ do not allocate; a poset must not be queried from two threads at once.
+ */
+
+#ifndef RF_POSET_H
+#define RF_POSET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "relation.h"
+
+typedef struct _rf_poset rf_Poset;
+
+struct _rf_poset {
+        int           n;
+        int           *order;           /*!< Element at each position of the linear extension */
+        int           *position;        /*!< Position of each element, the inverse of order */
+        size_t        stride;           /*!< Words per row of up and down */
+        uint64_t      *up;              /*!< Per position, the positions of the elements above it */
+        uint64_t      *down;            /*!< Per position, the positions of the elements below it */
+        uint64_t      *bounds;          /*!< Scratch row of the queries */
+};
+
+rf_Poset *              rf_poset_new(const rf_Relation *relation, rf_Error *error);
+
+int                     rf_poset_join(const rf_Poset *poset, int x, int y);
+int                     rf_poset_meet(const rf_Poset *poset, int x, int y);
+bool                    rf_poset_is_lattice(const rf_Poset *poset, int pair[2]);
+
+void                    rf_poset_free(rf_Poset *poset);
+
+#endif
@@ -29,29 +29,171 @@
 #define RF_RELATION_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
 
 #include "set.h"
 #include "error.h"
+#include "bitrow.h"
+#include "index_set.h"
 
-typedef struct _rf_relation rf_Relation;
+enum _rf_relation_property {
+        RF_PROPERTY_HOMOGENEOUS         = 1 << 0,
+        RF_PROPERTY_REFLEXIVE           = 1 << 1,
+        RF_PROPERTY_IRREFLEXIVE         = 1 << 2,
+        RF_PROPERTY_SYMMETRIC           = 1 << 3,
+        RF_PROPERTY_ANTISYMMETRIC       = 1 << 4,
+        RF_PROPERTY_ASYMMETRIC          = 1 << 5,
+        RF_PROPERTY_TRANSITIVE          = 1 << 6,
+        RF_PROPERTY_EQUIVALENT          = 1 << 7,
+        RF_PROPERTY_PREORDER            = 1 << 8,
+        RF_PROPERTY_PARTIAL_ORDER       = 1 << 9,
+        RF_PROPERTY_DIFUNCTIONAL        = 1 << 10,
+        RF_PROPERTY_LEFTTOTAL           = 1 << 11,
+        RF_PROPERTY_FUNCTIONAL          = 1 << 12,
+        RF_PROPERTY_FUNCTION            = 1 << 13,
+        RF_PROPERTY_SURJECTIVE          = 1 << 14,
+        RF_PROPERTY_INJECTIVE           = 1 << 15,
+        RF_PROPERTY_BIJECTIVE           = 1 << 16,
+};
+
+#define RF_PROPERTY_ALL         ((1u << 17) - 1)
+
+typedef struct _rf_relation             rf_Relation;
+typedef struct _rf_relation_witness     rf_RelationWitness;
+typedef struct _rf_relation_tracker     rf_RelationTracker;
+typedef enum _rf_relation_property      rf_RelationProperty;
 
 struct _rf_relation {
         rf_Set        **domains;
-        bool          *table;
+        uint64_t      *table;   /*!< Bit-packed rows, one padded bitrow per element of domains[0] */
+        size_t        stride;   /*!< Words per row, rf_bitrow_words(domains[1]->cardinality) */
+        unsigned int  known;    /*!< Cache: rf_RelationProperty bits decided since the table last changed */
+        unsigned int  properties; /*!< Cache: the bits of known that hold */
+        rf_RelationTracker *tracker; /*!< Counters kept by rf_relation_set, NULL unless tracked */
+        uint64_t      *transpose; /*!< Cache: table of the converse, kept for column queries */
+        bool          transposed; /*!< Whether transpose matches the table */
+        bool          in_arena; /*!< Freed with its arena, see arena.h */
+};
+
+/*
+ * Counters of a tracked relation (see rf_relation_track). rf_relation_set updates
+ * them in O(1) per changed cell, so reflexivity, symmetry, antisymmetry and the
+ * function properties can be answered without a scan. Bulk changes only mark them
+ * stale; they are recounted on the next query.
+ */
+struct _rf_relation_tracker {
+        bool          stale;
+        bool          homogeneous;
+        size_t        diagonal;         /*!< Pairs xRx */
+        size_t        asymmetric;       /*!< Pairs xRy, x != y, without yRx */
+        size_t        symmetric;        /*!< Unordered pairs x != y with xRy and yRx */
+        size_t        empty_rows;       /*!< Rows without pairs */
+        size_t        multi_rows;       /*!< Rows with more than one pair */
+        size_t        empty_columns;
+        size_t        multi_columns;
+        int           *degrees;         /*!< Pairs per row, followed by pairs per column */
 };
 
+/*
+ * Counterexample to a property, as found by the rf_relation_is_*_witness functions.
+ * property is the one refuted: a composite like RF_PROPERTY_PARTIAL_ORDER is refuted
+ * by one of its parts, a heterogeneous relation by RF_PROPERTY_HOMOGENEOUS, the
+ * lattice condition by 0. The entries are:
+ *
+ *  reflexive, irreflexive   x with (not) xRx
+ *  symmetric                x, y with xRy but not yRx
+ *  antisymmetric            x, y with x != y, xRy and yRx
+ *  transitive               x, y, z with xRy, yRz but not xRz
+ *  difunctional             x, y, z, w with xRy, zRy, zRw but not xRw
+ *  lefttotal, surjective    x without any xRy, y without any xRy
+ *  functional               x, y, z with y < z, xRy and xRz
+ *  injective                x, z, y with x < z, xRy and zRy
+ *  lattice                  x, y without supremum or infimum
+ *
+ * index holds their positions in the domain they come from, elements the elements
+ * themselves, which belong to the domains of the relation.
+ */
+struct _rf_relation_witness {
+        rf_RelationProperty property;
+        int           n;        /*!< Number of valid entries, 0 if there is no counterexample in the table */
+        int           index[4];
+        rf_SetElement *elements[4];
+};
+
+/*
+ * Cell access. Row x of the table starts at word x * stride, cell (x, y) is bit y of
+ * that row. These are meant for inner loops; bounds are only checked by assert.
+ * Writes through rf_relation_row bypass the property cache, see
+ * rf_relation_invalidate.
+ */
+static inline uint64_t *
+rf_relation_row(rf_Relation *r, int x) {
+        assert(x >= 0 && x < r->domains[0]->cardinality);
+        return &r->table[(size_t) x * r->stride];
+}
+
+static inline const uint64_t *
+rf_relation_row_const(const rf_Relation *r, int x) {
+        assert(x >= 0 && x < r->domains[0]->cardinality);
+        return &r->table[(size_t) x * r->stride];
+}
+
+static inline bool
+rf_relation_get(const rf_Relation *r, int x, int y) {
+        assert(y >= 0 && y < r->domains[1]->cardinality);
+        return rf_bitrow_get(rf_relation_row_const(r, x), y);
+}
+
+void            rf_relation_track_cell(rf_Relation *relation, int x, int y, bool value);
+
+/*
+ * Forgets the cached properties except homogeneity, which only depends on the
+ * domains, and the cached transpose, and marks the counters of a tracked relation
+ * stale. The make_* functions
+ * do this themselves, code that writes to the rows directly has to call it.
+ */
+static inline void
+rf_relation_invalidate(rf_Relation *r) {
+        r->known &= RF_PROPERTY_HOMOGENEOUS;
+        r->transposed = false;
+        if(r->tracker != NULL)
+                r->tracker->stale = true;
+}
+
+static inline void
+rf_relation_set(rf_Relation *r, int x, int y, bool value) {
+        assert(y >= 0 && y < r->domains[1]->cardinality);
+        r->known &= RF_PROPERTY_HOMOGENEOUS;
+        r->transposed = false;
+        if(r->tracker != NULL && !r->tracker->stale)
+                rf_relation_track_cell(r, x, y, value);
+        if(value)
+                rf_bitrow_set(rf_relation_row(r, x), y);
+        else
+                rf_bitrow_clear(rf_relation_row(r, x), y);
+}
+
 
 bool            rf_relation_calc(rf_Relation *relation, rf_SetElement *element1, rf_SetElement *element2, rf_Error *error);
 
 
 rf_Relation *   rf_relation_new(rf_Set *domain1, rf_Set *domain2, bool *table);
+rf_Relation *   rf_relation_new_in(rf_Arena *arena, rf_Set *domain1, rf_Set *domain2, bool *table);
 rf_Relation *   rf_relation_clone(const rf_Relation *relation);
+rf_Relation *   rf_relation_clone_in(rf_Arena *arena, const rf_Relation *relation);
 
 rf_Relation *   rf_relation_new_empty(rf_Set *domain1, rf_Set *domain2);
+rf_Relation *   rf_relation_new_empty_in(rf_Arena *arena, rf_Set *domain1, rf_Set *domain2);
 rf_Relation *   rf_relation_new_full(rf_Set *domain1, rf_Set *domain2);
+rf_Relation *   rf_relation_new_full_in(rf_Arena *arena, rf_Set *domain1, rf_Set *domain2);
 rf_Relation *   rf_relation_new_id(rf_Set *domain);
+rf_Relation *   rf_relation_new_id_in(rf_Arena *arena, rf_Set *domain);
 rf_Relation *   rf_relation_new_top(rf_Set *domain);
+rf_Relation *   rf_relation_new_top_in(rf_Arena *arena, rf_Set *domain);
 rf_Relation *   rf_relation_new_bottom(rf_Set *domain);
+rf_Relation *   rf_relation_new_bottom_in(rf_Arena *arena, rf_Set *domain);
 rf_Relation *   rf_relation_new_union(rf_Relation *relation_1, rf_Relation *relation_2, rf_Error *error);
 rf_Relation *   rf_relation_new_intersection(rf_Relation *relation_1, rf_Relation *relation_2, rf_Error *error);
 rf_Relation *   rf_relation_new_complement(rf_Relation *relation, rf_Error *error);
@@ -60,6 +202,10 @@ rf_Relation *   rf_relation_new_converse(const rf_Relation *relation, rf_Error *
 rf_Relation *   rf_relation_new_subsetleq(rf_Set *domain, rf_Error *error);
 
 bool            rf_relation_is_homogeneous(const rf_Relation *relation);
+unsigned int    rf_relation_properties(const rf_Relation *relation);
+
+bool            rf_relation_track(rf_Relation *relation, rf_Error *error);
+void            rf_relation_untrack(rf_Relation *relation);
 
 bool            rf_relation_is_antisymmetric(const rf_Relation *relation);
 bool            rf_relation_is_asymmetric(const rf_Relation *relation);
@@ -80,21 +226,60 @@ bool            rf_relation_is_surjective(const rf_Relation *relation);
 bool            rf_relation_is_injective(const rf_Relation *relation);
 bool            rf_relation_is_bijective(const rf_Relation *relation);
 
+bool            rf_relation_is_antisymmetric_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_asymmetric_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_difunctional_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_equivalent_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_irreflexive_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_partial_order_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_preorder_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_reflexive_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_symmetric_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_transitive_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_lattice_witness(const rf_Relation *relation, rf_RelationWitness *witness, rf_Error *error);
+bool            rf_relation_is_lefttotal_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_functional_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_function_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_surjective_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_injective_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+bool            rf_relation_is_bijective_witness(const rf_Relation *relation, rf_RelationWitness *witness);
+
+size_t          rf_relation_count_violations(const rf_Relation *relation, rf_RelationProperty property, rf_Error *error);
+
 
 rf_Set *        rf_relation_find_minimal_elements(const rf_Relation *r, rf_Set *s, rf_Error *error);
 rf_SetElement * rf_relation_find_minimum_within_subset(const rf_Relation *r, rf_Set *s, rf_Error *error);
 rf_Set *        rf_relation_find_maximal_elements(const rf_Relation *r, rf_Set *s, rf_Error *error);
-rf_SetElement * rf_relation_find_mmaximum_within_subset(const rf_Relation *r, rf_Set *s, rf_Error *error);
+rf_SetElement * rf_relation_find_maximum_within_subset(const rf_Relation *r, rf_Set *s, rf_Error *error);
 rf_SetElement * rf_relation_find_infimum(const rf_Relation *relation, const rf_Set *domain, rf_Error *error);
 rf_SetElement * rf_relation_find_maximum(const rf_Relation *relation, rf_Error *error);
 rf_SetElement * rf_relation_find_minimum(const rf_Relation *relation, rf_Error *error);
 rf_SetElement * rf_relation_find_supremum(const rf_Relation *relation, const rf_Set *domain, rf_Error *error);
 rf_Set *        rf_relation_find_upperbound(const rf_Relation *relation, const rf_Set *domain, rf_Error *error);
 rf_Set *        rf_relation_find_lowerbound(const rf_Relation *relation, const rf_Set *domain, rf_Error *error);
+rf_Set *        rf_relation_get_image(const rf_Relation *relation, rf_Set *subrelation);
+rf_Set *        rf_relation_get_preImage(const rf_Relation *relation, rf_Set *subrelation);
+
+/*
+ * Queries on element indices. They write to a result set of the caller, which is
+ * cleared first and must not be one of the arguments, and allocate nothing of their
+ * own; rf_index_set_to_set turns a result into an rf_Set.
+ */
+bool            rf_relation_minimal_elements(const rf_Relation *relation, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error);
+bool            rf_relation_maximal_elements(const rf_Relation *relation, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error);
+bool            rf_relation_upper_bounds(const rf_Relation *relation, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error);
+bool            rf_relation_lower_bounds(const rf_Relation *relation, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error);
+void            rf_relation_image(const rf_Relation *relation, const rf_IndexSet *elements, rf_IndexSet *result);
+void            rf_relation_preimage(const rf_Relation *relation, const rf_IndexSet *elements, rf_IndexSet *result);
 int             rf_relation_find_transitive_gaps(rf_Relation *r, int *occurrences, rf_Set *gaps, rf_Error *error);
 bool            rf_relation_guess_transitive_core(rf_Relation *r, rf_Error *error);
 rf_Relation *   rf_relation_find_transitive_hard_core(rf_Relation *relation, rf_Error *error);
 
+bool            rf_relation_make_union(rf_Relation *relation_1, const rf_Relation *relation_2, rf_Error *error);
+bool            rf_relation_make_intersection(rf_Relation *relation_1, const rf_Relation *relation_2, rf_Error *error);
+bool            rf_relation_make_complement(rf_Relation *relation, rf_Error *error);
+bool            rf_relation_make_converse(rf_Relation *relation, rf_Error *error);
+
 bool            rf_relation_make_antisymmetric(rf_Relation *relation, bool upper, rf_Error *error);
 bool            rf_relation_make_asymmetric(rf_Relation *relation, bool upper, rf_Error *error);
 bool            rf_relation_make_difunctional(rf_Relation *relation, bool fill, rf_Error *error);
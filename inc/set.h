@@ -21,6 +21,9 @@
 #define RF_SET_H
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
 
 enum _rf_set_element_type {
         RF_SET_ELEMENT_TYPE_STRING,
@@ -30,34 +33,76 @@ enum _rf_set_element_type {
 typedef struct _rf_set                  rf_Set;
 typedef struct _rf_set_element          rf_SetElement;
 typedef enum _rf_set_element_type       rf_SetElementType;
+typedef struct _rf_set_index            rf_SetIndex;
+
+#define RF_SET_INDEX_MIN        16      /*!< Sets this large get a hash index on their first lookup */
 
+/*
+ * index is built by the first rf_set_get_element_index on a set of RF_SET_INDEX_MIN
+ * or more members and answers the lookups after it in O(1). Code that changes the
+ * members has to call rf_set_invalidate; until then changes to cardinality or
+ * elements are noticed and lookups scan.
+ *
+ * Lookups, comparisons and other functions taking a const rf_Set may run on one set
+ * from several threads at once. Changing a set, rf_set_sort and rf_set_invalidate
+ * included, must not overlap with any other use of it.
+ *
+ * Sets made by rf_set_new_sorted or rf_set_sort keep their members in the canonical
+ * order of rf_set_element_compare, without duplicates. Comparing, intersecting,
+ * uniting and subtracting two of them merges the members in order; the smaller set
+ * gallops through the larger, O(n log(m / n)) comparisons. Other sets use the index.
+ *
+ * Sets and elements made by the _in constructors live in an arena. rf_set_free and
+ * rf_set_element_free do nothing for them. An arena set may take members from
+ * outside the arena; they are freed when the arena is cleared.
+ */
 struct _rf_set {
         unsigned int    cardinality;    /*!< Number of Members */
         rf_SetElement   **elements;     /*!< Members */
+        rf_SetIndex     *index;         /*!< Cache: hash index of the members, NULL until needed */
+        bool            sorted;         /*!< Members in canonical order */
+        bool            in_arena;       /*!< Freed with its arena */
 };
 
+/*
+ * Equal elements share their key, an atom (see atom.h): the string itself, or for a
+ * set the atom of its members' keys in a fixed order. Comparing and hashing elements
+ * takes O(1) at any depth of nesting; the set keeps the order it was made with.
+ */
 struct _rf_set_element {
         rf_SetElementType       type;
+        bool                    in_arena;       /*!< Freed with its arena */
         union {
-                char    *string;
+                const char *string;     /*!< An atom, see atom.h */
                 rf_Set  *set;
         } value;
+        const char              *key;   /*!< Identity of the value */
 };
 
 
 rf_Set *        rf_set_new(int n, rf_SetElement **elements);
+rf_Set *        rf_set_new_in(rf_Arena *arena, int n, rf_SetElement **elements);
+rf_Set *        rf_set_new_sorted(int n, rf_SetElement **elements);
 rf_Set *        rf_set_clone(const rf_Set *set);
+rf_Set *        rf_set_clone_in(rf_Arena *arena, const rf_Set *set);
 
 rf_Set *        rf_set_new_intersection(const rf_Set *, const rf_Set *);
+rf_Set *        rf_set_new_union(const rf_Set *, const rf_Set *);
+rf_Set *        rf_set_new_difference(const rf_Set *, const rf_Set *);
 rf_Set *        rf_set_new_powerset(const rf_Set *set);
+rf_Set *        rf_set_new_powerset_in(rf_Arena *arena, const rf_Set *set);
+
+void            rf_set_sort(rf_Set *set);
 
 int             rf_set_get_cardinality(const rf_Set *);
 bool            rf_set_equal(const rf_Set *a, const rf_Set *b);
+int             rf_set_compare(const rf_Set *a, const rf_Set *b);
 /*! Checks if subset is a strict subset of superset */
 bool            rf_set_is_subset(const rf_Set *subset, const rf_Set *superset);
 
 bool            rf_set_contains_element(const rf_Set *set, const rf_SetElement *element);
 int             rf_set_get_element_index(const rf_Set *set, const rf_SetElement *element);
+void            rf_set_invalidate(rf_Set *set);
 
 void            rf_set_free(rf_Set *set);
 
@@ -68,10 +113,15 @@ void            rf_set_free(rf_Set *set);
         default : ) (value)
 #endif
 rf_SetElement * rf_set_element_new_string(char *value);
+rf_SetElement * rf_set_element_new_string_in(rf_Arena *arena, const char *value);
 rf_SetElement * rf_set_element_new_set(rf_Set *value);
+rf_SetElement * rf_set_element_new_set_in(rf_Arena *arena, const rf_Set *value);
 rf_SetElement * rf_set_element_clone(const rf_SetElement *element);
+rf_SetElement * rf_set_element_clone_in(rf_Arena *arena, const rf_SetElement *element);
 
 bool            rf_set_element_equal(const rf_SetElement *a, const rf_SetElement *b);
+int             rf_set_element_compare(const rf_SetElement *a, const rf_SetElement *b);
+uint64_t        rf_set_element_hash(const rf_SetElement *element);
 
 void            rf_set_element_free(rf_SetElement *element);
 
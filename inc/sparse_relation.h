@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Sparse relations.
+
+ rf_SparseRelation stores a relation as adjacency lists (compressed sparse rows):
+ the elements related to x are targets[offsets[x]] up to targets[offsets[x+1]-1],
+ sorted ascending. It is meant for large relations with few pairs per element where
+ the bit table of rf_Relation would not fit into memory.
+
+ The transitive closure works on the strongly connected components: every element
+ of a component reaches the same elements, so the closure is computed once per
+ component on the acyclic condensation.
+ */
+
+#ifndef RF_SPARSE_RELATION_H
+#define RF_SPARSE_RELATION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "set.h"
+#include "error.h"
+#include "relation.h"
+
+typedef struct _rf_sparse_relation rf_SparseRelation;
+
+struct _rf_sparse_relation {
+        rf_Set        **domains;
+        size_t        *offsets; /*!< domains[0]->cardinality + 1 row starts into targets */
+        int           *targets; /*!< Indices into domains[1], ascending within a row */
+};
+
+rf_SparseRelation *     rf_sparse_relation_new(rf_Set *domain1, rf_Set *domain2, size_t count, const int *x, const int *y);
+rf_SparseRelation *     rf_sparse_relation_new_from_relation(const rf_Relation *relation);
+rf_SparseRelation *     rf_sparse_relation_new_closure(const rf_SparseRelation *relation, rf_Error *error);
+
+rf_Relation *           rf_sparse_relation_to_relation(const rf_SparseRelation *relation);
+bool                    rf_sparse_relation_get(const rf_SparseRelation *relation, int x, int y);
+size_t                  rf_sparse_relation_count(const rf_SparseRelation *relation);
+
+bool                    rf_sparse_relation_close_relation(rf_Relation *relation, rf_Error *error);
+
+void                    rf_sparse_relation_free(rf_SparseRelation *relation);
+
+#endif
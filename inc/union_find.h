@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \file
+ Disjoint sets.
+
+ rf_UnionFind partitions the numbers 0 .. n-1 into classes. Uniting two classes and
+ finding the representative of a number take nearly constant amortized time (union
+ by size, path halving). The closures of equivalences and difunctional relations
+ are built on it.
+ */
+
+#ifndef RF_UNION_FIND_H
+#define RF_UNION_FIND_H
+
+#include <stdbool.h>
+
+typedef struct _rf_union_find rf_UnionFind;
+
+struct _rf_union_find {
+        int           n;
+        int           *parent;  /*!< parent[x] == x for representatives */
+        int           *size;    /*!< Members of the class, valid for representatives */
+};
+
+rf_UnionFind *          rf_union_find_new(int n);
+
+int                     rf_union_find_find(rf_UnionFind *uf, int x);
+bool                    rf_union_find_union(rf_UnionFind *uf, int x, int y);
+
+void                    rf_union_find_free(rf_UnionFind *uf);
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "arena.h"
+
+#define RF_ARENA_ALIGN          16
+#define RF_ARENA_CHUNK_SIZE     65536
+
+#define RF_ARENA_ROUND(size)    (((size) + RF_ARENA_ALIGN - 1) & ~(size_t) (RF_ARENA_ALIGN - 1))
+
+/*
+ * Data follows the header, rounded up to the alignment. Memory is handed out from
+ * the front of the first chunk. Requests larger than a
+ * quarter chunk get a chunk of their own behind it, so the first one keeps filling.
+ */
+typedef struct _rf_arena_chunk rf_ArenaChunk;
+struct _rf_arena_chunk {
+	rf_ArenaChunk   *next;
+	size_t          size;           /*!< Bytes of data */
+	size_t          used;
+};
+
+typedef struct _rf_arena_deferred rf_ArenaDeferred;
+struct _rf_arena_deferred {
+	rf_ArenaDeferred        *next;
+	void                    (*release)(void *object);
+	void                    *object;
+};
+
+struct _rf_arena {
+	rf_ArenaChunk           *chunks;
+	rf_ArenaDeferred        *deferred;      /*!< Most recent first */
+	size_t                  size;           /*!< Bytes handed out */
+};
+
+static rf_ArenaChunk *
+rf_arena_chunk_new(size_t size) {
+	rf_ArenaChunk *chunk = malloc(RF_ARENA_ROUND(sizeof(*chunk)) + size);
+	if(chunk == NULL)
+		return NULL;
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	return chunk;
+}
+
+static char *
+rf_arena_chunk_data(rf_ArenaChunk *chunk) {
+	return (char *) chunk + RF_ARENA_ROUND(sizeof(*chunk));
+}
+
+rf_Arena *
+rf_arena_new(void) {
+	rf_Arena *arena = malloc(sizeof(*arena));
+	if(arena == NULL)
+		return NULL;
+	arena->chunks = NULL;
+	arena->deferred = NULL;
+	arena->size = 0;
+
+	return arena;
+}
+
+/*
+ * size bytes aligned for any of the library's objects, NULL if there is no memory.
+ * Without an arena this is malloc.
+ */
+void *
+rf_arena_alloc(rf_Arena *arena, size_t size) {
+	if(arena == NULL)
+		return malloc(size);
+
+	size = RF_ARENA_ROUND(size > 0 ? size : 1);
+
+	rf_ArenaChunk *chunk = arena->chunks;
+	if(chunk == NULL || chunk->size - chunk->used < size) {
+		if(size > RF_ARENA_CHUNK_SIZE / 4 && chunk != NULL) {
+			rf_ArenaChunk *own = rf_arena_chunk_new(size);
+			if(own == NULL)
+				return NULL;
+			own->used = size;
+			own->next = chunk->next;
+			chunk->next = own;
+			arena->size += size;
+			return rf_arena_chunk_data(own);
+		}
+
+		chunk = rf_arena_chunk_new(size > RF_ARENA_CHUNK_SIZE ? size : RF_ARENA_CHUNK_SIZE);
+		if(chunk == NULL)
+			return NULL;
+		chunk->next = arena->chunks;
+		arena->chunks = chunk;
+	}
+
+	void *p = rf_arena_chunk_data(chunk) + chunk->used;
+	chunk->used += size;
+	arena->size += size;
+
+	return p;
+}
+
+/*
+ * Has release(object) called when the arena is cleared, before its memory goes and
+ * in reverse order of the calls to rf_arena_defer. false if there is no memory to
+ * note it; release is then never called.
+ */
+bool
+rf_arena_defer(rf_Arena *arena, void (*release)(void *object), void *object) {
+	assert(arena != NULL);
+	assert(release != NULL);
+
+	rf_ArenaDeferred *d = rf_arena_alloc(arena, sizeof(*d));
+	if(d == NULL)
+		return false;
+	d->release = release;
+	d->object = object;
+	d->next = arena->deferred;
+	arena->deferred = d;
+
+	return true;
+}
+
+size_t
+rf_arena_size(const rf_Arena *arena) {
+	assert(arena != NULL);
+
+	return arena->size;
+}
+
+/*
+ * Frees everything allocated in the arena. It stays usable and keeps one chunk.
+ */
+void
+rf_arena_clear(rf_Arena *arena) {
+	assert(arena != NULL);
+
+	for(rf_ArenaDeferred *d = arena->deferred; d != NULL; d = d->next)
+		d->release(d->object);
+	arena->deferred = NULL;
+
+	rf_ArenaChunk *keep = NULL;
+	rf_ArenaChunk *chunk = arena->chunks;
+	while(chunk != NULL) {
+		rf_ArenaChunk *next = chunk->next;
+		if(keep == NULL && chunk->size == RF_ARENA_CHUNK_SIZE) {
+			keep = chunk;
+			keep->used = 0;
+			keep->next = NULL;
+		} else {
+			free(chunk);
+		}
+		chunk = next;
+	}
+	arena->chunks = keep;
+	arena->size = 0;
+}
+
+void
+rf_arena_free(rf_Arena *arena) {
+	assert(arena != NULL);
+
+	rf_arena_clear(arena);
+	free(arena->chunks);
+	free(arena);
+}
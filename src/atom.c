@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "atom.h"
+
+/*
+ * An atom is handed out as a pointer to its string, the header sits in front of it.
+ */
+typedef struct {
+	uint64_t        hash;
+	unsigned int    id;
+	unsigned int    refs;           /*!< Changed atomically */
+	size_t          length;
+	char            string[];
+} rf_Atom;
+
+#define RF_ATOM(atom)   ((rf_Atom *) ((atom) - offsetof(rf_Atom, string)))
+
+/*
+ * Open addressing over a power of two slots, at most half of them used. Atoms with a
+ * reference count of zero are removed under the lock that brought them there, so
+ * lookups never see them.
+ */
+static struct {
+	pthread_mutex_t lock;
+	rf_Atom         **slots;
+	size_t          mask;           /*!< Slots - 1, 0 before the first atom */
+	size_t          count;
+	unsigned int    next_id;
+} rf_atoms = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0 };
+
+/*
+ * FNV-1a
+ */
+static uint64_t
+rf_atom_hash_string(const char *string, size_t length) {
+	uint64_t hash = UINT64_C(14695981039346656037);
+	for(size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char) string[i];
+		hash *= UINT64_C(1099511628211);
+	}
+
+	return hash;
+}
+
+/*
+ * Doubles the slots, or makes the first ones. False if there is no memory for them.
+ */
+static bool
+rf_atom_grow(void) {
+	const size_t slots = rf_atoms.slots == NULL ? 64 : 2 * (rf_atoms.mask + 1);
+	rf_Atom **grown = calloc(slots, sizeof(*grown));
+	if(grown == NULL)
+		return false;
+
+	for(size_t i = 0; rf_atoms.slots != NULL && i <= rf_atoms.mask; i++) {
+		if(rf_atoms.slots[i] == NULL)
+			continue;
+		size_t slot = rf_atoms.slots[i]->hash & (slots - 1);
+		while(grown[slot] != NULL)
+			slot = (slot + 1) & (slots - 1);
+		grown[slot] = rf_atoms.slots[i];
+	}
+	free(rf_atoms.slots);
+	rf_atoms.slots = grown;
+	rf_atoms.mask = slots - 1;
+
+	return true;
+}
+
+/*
+ * The atom equal to string, with one more reference. NULL if there is no memory for
+ * a new one.
+ */
+const char *
+rf_atom_intern(const char *string) {
+	assert(string != NULL);
+
+	return rf_atom_intern_bytes(string, strlen(string));
+}
+
+/*
+ * The atom of length bytes, which may contain NUL. It is stored with a NUL appended.
+ */
+const char *
+rf_atom_intern_bytes(const void *bytes, size_t length) {
+	assert(bytes != NULL || length == 0);
+
+	const char *string = bytes;
+	const uint64_t hash = rf_atom_hash_string(string, length);
+	rf_Atom *atom = NULL;
+
+	pthread_mutex_lock(&rf_atoms.lock);
+
+	if(2 * (rf_atoms.count + 1) > rf_atoms.mask + 1 && !rf_atom_grow()) {
+		pthread_mutex_unlock(&rf_atoms.lock);
+		return NULL;
+	}
+
+	size_t slot = hash & rf_atoms.mask;
+	for(; rf_atoms.slots[slot] != NULL; slot = (slot + 1) & rf_atoms.mask) {
+		rf_Atom *a = rf_atoms.slots[slot];
+		if(a->hash == hash && a->length == length && (length == 0 || memcmp(a->string, string, length) == 0)) {
+			__atomic_add_fetch(&a->refs, 1, __ATOMIC_RELAXED);
+			atom = a;
+			break;
+		}
+	}
+
+	if(atom == NULL) {
+		atom = malloc(sizeof(*atom) + length + 1);
+		if(atom != NULL) {
+			atom->hash = hash;
+			atom->id = rf_atoms.next_id++;
+			atom->refs = 1;
+			atom->length = length;
+			memcpy(atom->string, string, length);
+			atom->string[length] = '\0';
+			rf_atoms.slots[slot] = atom;
+			rf_atoms.count++;
+		}
+	}
+
+	pthread_mutex_unlock(&rf_atoms.lock);
+
+	return atom != NULL ? atom->string : NULL;
+}
+
+/*
+ * One more reference to an atom the caller holds, O(1).
+ */
+const char *
+rf_atom_acquire(const char *atom) {
+	assert(atom != NULL);
+
+	__atomic_add_fetch(&RF_ATOM(atom)->refs, 1, __ATOMIC_RELAXED);
+
+	return atom;
+}
+
+/*
+ * Gives a reference back. The last one removes the atom from the table: the entries
+ * after it that would have been placed in its slot move up, keeping every probe
+ * sequence unbroken.
+ */
+void
+rf_atom_release(const char *atom) {
+	assert(atom != NULL);
+
+	rf_Atom *a = RF_ATOM(atom);
+
+	pthread_mutex_lock(&rf_atoms.lock);
+
+	if(__atomic_sub_fetch(&a->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+		size_t hole = a->hash & rf_atoms.mask;
+		while(rf_atoms.slots[hole] != a)
+			hole = (hole + 1) & rf_atoms.mask;
+
+		for(size_t slot = (hole + 1) & rf_atoms.mask; rf_atoms.slots[slot] != NULL; slot = (slot + 1) & rf_atoms.mask) {
+			const size_t home = rf_atoms.slots[slot]->hash & rf_atoms.mask;
+			// stays unless its home lies cyclically outside (hole, slot]
+			const bool stays = hole < slot ? home > hole && home <= slot : home > hole || home <= slot;
+			if(!stays) {
+				rf_atoms.slots[hole] = rf_atoms.slots[slot];
+				hole = slot;
+			}
+		}
+		rf_atoms.slots[hole] = NULL;
+		rf_atoms.count--;
+		free(a);
+	}
+
+	pthread_mutex_unlock(&rf_atoms.lock);
+}
+
+uint64_t
+rf_atom_hash(const char *atom) {
+	assert(atom != NULL);
+
+	return RF_ATOM(atom)->hash;
+}
+
+unsigned int
+rf_atom_id(const char *atom) {
+	assert(atom != NULL);
+
+	return RF_ATOM(atom)->id;
+}
+
+/*
+ * Number of atoms alive.
+ */
+size_t
+rf_atom_count(void) {
+	pthread_mutex_lock(&rf_atoms.lock);
+	const size_t count = rf_atoms.count;
+	pthread_mutex_unlock(&rf_atoms.lock);
+
+	return count;
+}
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "bitmatrix.h"
+#include "bitrow.h"
+
+/*
+ * Column block of the product: 64 words = 4096 columns, 512 bytes per row segment.
+ */
+#define BLOCK_WORDS     64
+/*
+ * Rows of b per block on the sparse path. 256 row segments of BLOCK_WORDS words
+ * (128 KiB) stay in L2 while every row of a is streamed past them.
+ */
+#define BLOCK_ROWS      256
+
+/*
+ * Upper bound for the pivot rows of one Warshall step, they are reread for every
+ * other row and should stay in L2.
+ */
+#define PANEL_BYTES     (256 * 1024)
+
+#define MIN(a, b)       ((a) < (b) ? (a) : (b))
+
+/*
+ * c |= a * b for one column block, ORing row j of b into row i of c for every set bit
+ * (i, j) of a.
+ */
+static void
+product_rows(uint64_t *c, size_t c_stride, const uint64_t *a, size_t a_stride,
+             const uint64_t *b, size_t b_stride, size_t n, size_t k, size_t w0, size_t wn) {
+	const size_t k_words = (k + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+
+	for(size_t k0 = 0; k0 < k_words; k0 += BLOCK_ROWS / RF_BITROW_WORD_BITS) {
+		const size_t k1 = MIN(k_words, k0 + BLOCK_ROWS / RF_BITROW_WORD_BITS);
+		for(size_t i = 0; i < n; i++) {
+			const uint64_t *ai = &a[i * a_stride];
+			uint64_t *ci = &c[i * c_stride + w0];
+			for(size_t kw = k0; kw < k1; kw++) {
+				for(uint64_t bits = ai[kw]; bits != 0; bits &= bits - 1) {
+					size_t j = kw * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+					rf_bitrow_or(ci, ci, &b[j * b_stride + w0], wn);
+				}
+			}
+		}
+	}
+}
+
+/*
+ * c |= a * b for one column block using the method of four Russians: for every group
+ * of 8 rows of b all 256 ORs of them are tabulated once, then every row of c takes a
+ * single table entry per group instead of up to 8 row ORs. Column a_col of a pairs
+ * with row 0 of b.
+ */
+static void
+product_m4r(uint64_t *c, size_t c_stride, const uint64_t *a, size_t a_stride, size_t a_col,
+            const uint64_t *b, size_t b_stride, size_t n, size_t k, size_t w0, size_t wn,
+            uint64_t *table) {
+	for(size_t k0 = 0; k0 < k; k0 += 8) {
+		const size_t rows = MIN(8, k - k0);
+
+		// table[v] = OR of the rows k0 + i of b for every bit i of v
+		for(size_t w = 0; w < wn; w++)
+			table[w] = 0;
+		for(unsigned int v = 1; v < (1u << rows); v++) {
+			unsigned int low = rf_bitrow_ctz(v);
+			rf_bitrow_or(&table[v * wn], &table[(v & (v - 1)) * wn], &b[(k0 + low) * b_stride + w0], wn);
+		}
+
+		const size_t kw = (a_col + k0) / RF_BITROW_WORD_BITS;
+		const unsigned int shift = (a_col + k0) % RF_BITROW_WORD_BITS;
+		const unsigned int mask = (1u << rows) - 1;
+		for(size_t i = 0; i < n; i++) {
+			unsigned int v = (a[i * a_stride + kw] >> shift) & mask;
+			if(v != 0) {
+				uint64_t *ci = &c[i * c_stride + w0];
+				rf_bitrow_or(ci, ci, &table[v * wn], wn);
+			}
+		}
+	}
+}
+
+/*
+ * Boolean matrix product c = a * b with a being n x k and b being k x m, i.e.
+ * c[i][j] = OR over l of a[i][l] AND b[l][j]. c must not alias a or b and is
+ * overwritten. The product is computed in column blocks so the touched part of b
+ * stays in cache; dense inputs take the four Russians path, sparse ones OR single
+ * rows. Returns false if the lookup table could not be allocated.
+ */
+bool
+rf_bitmatrix_product(uint64_t *c, size_t c_stride,
+                     const uint64_t *a, size_t a_stride,
+                     const uint64_t *b, size_t b_stride,
+                     size_t n, size_t k, size_t m) {
+	assert(c != NULL || n == 0);
+	assert(c != a && c != b);
+
+	const size_t m_words = (m + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+	const size_t k_words = (k + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+
+	for(size_t i = 0; i < n; i++)
+		for(size_t w = 0; w < c_stride; w++)
+			c[i * c_stride + w] = 0;
+
+	if(n == 0 || k == 0 || m == 0)
+		return true;
+
+	/*
+	 * Per group of 8 rows of b the row path ORs about 8 * density * n rows,
+	 * the table path 256 + n rows.
+	 */
+	size_t ones = 0;
+	for(size_t i = 0; i < n; i++)
+		ones += rf_bitrow_count(&a[i * a_stride], k_words);
+	const bool dense = 8 * ones > (256 + n) * k;
+
+	uint64_t *table = NULL;
+	if(dense) {
+		table = rf_bitrow_alloc(256 * MIN(BLOCK_WORDS, m_words));
+		if(table == NULL)
+			return false;
+	}
+
+	for(size_t w0 = 0; w0 < m_words; w0 += BLOCK_WORDS) {
+		const size_t wn = MIN(BLOCK_WORDS, m_words - w0);
+		if(dense)
+			product_m4r(c, c_stride, a, a_stride, 0, b, b_stride, n, k, w0, wn, table);
+		else
+			product_rows(c, c_stride, a, a_stride, b, b_stride, n, k, w0, wn);
+	}
+
+	rf_bitrow_free(table);
+
+	return true;
+}
+
+/*
+ * Transposes a 64 x 64 bit block held as 64 words, bit j of word i moves to bit i of
+ * word j. Six rounds swap ever smaller off-diagonal sub-blocks: 32 x 32 quadrants
+ * first, single bits last.
+ */
+static void
+transpose_block(uint64_t a[64]) {
+	uint64_t mask = UINT64_C(0x00000000FFFFFFFF);
+	for(unsigned int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+		for(unsigned int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+			uint64_t t = ((a[k] >> j) ^ a[k | j]) & mask;
+			a[k] ^= t << j;
+			a[k | j] ^= t;
+		}
+	}
+}
+
+/*
+ * Copies the block at block row bi / block column bj of a n x m matrix, rows past n
+ * read as zero.
+ */
+static void
+load_block(uint64_t block[64], const uint64_t *src, size_t stride, size_t n, size_t bi, size_t bj) {
+	for(size_t i = 0; i < 64; i++) {
+		size_t row = bi * 64 + i;
+		block[i] = row < n ? src[row * stride + bj] : 0;
+	}
+}
+
+static void
+store_block(const uint64_t block[64], uint64_t *dst, size_t stride, size_t n, size_t bi, size_t bj) {
+	for(size_t i = 0; i < 64; i++) {
+		size_t row = bi * 64 + i;
+		if(row < n)
+			dst[row * stride + bj] = block[i];
+	}
+}
+
+/*
+ * Transposes the blocks [bi0, bi1) x [bj0, bj1) by halving the longer side until a
+ * single block is left, so at every level of the memory hierarchy the working set of
+ * some recursion level fits without knowing the cache sizes.
+ */
+static void
+transpose_rec(uint64_t *dst, size_t dst_stride, const uint64_t *src, size_t src_stride,
+              size_t n, size_t m, size_t bi0, size_t bi1, size_t bj0, size_t bj1) {
+	if(bi1 - bi0 > 1 && bi1 - bi0 >= bj1 - bj0) {
+		size_t mid = bi0 + (bi1 - bi0) / 2;
+		transpose_rec(dst, dst_stride, src, src_stride, n, m, bi0, mid, bj0, bj1);
+		transpose_rec(dst, dst_stride, src, src_stride, n, m, mid, bi1, bj0, bj1);
+	} else if(bj1 - bj0 > 1) {
+		size_t mid = bj0 + (bj1 - bj0) / 2;
+		transpose_rec(dst, dst_stride, src, src_stride, n, m, bi0, bi1, bj0, mid);
+		transpose_rec(dst, dst_stride, src, src_stride, n, m, bi0, bi1, mid, bj1);
+	} else {
+		uint64_t block[64];
+		load_block(block, src, src_stride, n, bi0, bj0);
+		transpose_block(block);
+		store_block(block, dst, dst_stride, m, bj0, bi0);
+	}
+}
+
+/*
+ * dst = transpose of src, src being n x m and dst m x n. dst must not alias src;
+ * the padding of dst rows is left as it is.
+ */
+void
+rf_bitmatrix_transpose(uint64_t *dst, size_t dst_stride,
+                       const uint64_t *src, size_t src_stride,
+                       size_t n, size_t m) {
+	assert(dst != src || n == 0 || m == 0);
+
+	const size_t n_blocks = (n + 63) / 64;
+	const size_t m_blocks = (m + 63) / 64;
+	if(n_blocks == 0 || m_blocks == 0)
+		return;
+
+	transpose_rec(dst, dst_stride, src, src_stride, n, m, 0, n_blocks, 0, m_blocks);
+}
+
+/*
+ * Transposes the n x n matrix a in place. Mirrored blocks are swapped pairwise,
+ * blocks on the diagonal are transposed where they are.
+ */
+void
+rf_bitmatrix_transpose_square(uint64_t *a, size_t stride, size_t n) {
+	const size_t blocks = (n + 63) / 64;
+
+	for(size_t bi = 0; bi < blocks; bi++) {
+		for(size_t bj = bi; bj < blocks; bj++) {
+			uint64_t upper[64], lower[64];
+			load_block(upper, a, stride, n, bi, bj);
+			transpose_block(upper);
+			if(bi == bj) {
+				store_block(upper, a, stride, n, bi, bi);
+				continue;
+			}
+			load_block(lower, a, stride, n, bj, bi);
+			transpose_block(lower);
+			store_block(upper, a, stride, n, bj, bi);
+			store_block(lower, a, stride, n, bi, bj);
+		}
+	}
+}
+
+/*
+ * Transitive closure of the n x n matrix a in place (Warshall).
+ *
+ * Pivots are taken in panels of up to 64 consecutive rows, all from the same word
+ * column. The panel rows are closed over the panel first, afterwards every other
+ * row ORs in the panel rows it has a bit for. Since a closed panel row already holds
+ * everything reachable through the panel, the bits a row had on entry are enough and
+ * bits gained on the way do no harm. Dense panels go through the four Russians
+ * tables of the product, sparse ones OR single rows while the panel stays cached.
+ */
+void
+rf_bitmatrix_closure(uint64_t *a, size_t stride, size_t n) {
+	size_t panel = RF_BITROW_WORD_BITS;
+	while(panel > 8 && panel * stride * sizeof(*a) > PANEL_BYTES)
+		panel /= 2;
+
+	const size_t n_words = (n + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+	uint64_t *table = rf_bitrow_alloc(256 * MIN(BLOCK_WORDS, n_words));
+
+	for(size_t k0 = 0; k0 < n; k0 += panel) {
+		const size_t k1 = MIN(n, k0 + panel);
+		const size_t kw = k0 / RF_BITROW_WORD_BITS;
+		const size_t shift = k0 % RF_BITROW_WORD_BITS;
+		const uint64_t mask = (k1 - k0 == RF_BITROW_WORD_BITS) ? ~UINT64_C(0)
+		                      : ((UINT64_C(1) << (k1 - k0)) - 1) << shift;
+
+		for(size_t k = k0; k < k1; k++) {
+			const uint64_t *ak = &a[k * stride];
+			for(size_t i = k0; i < k1; i++) {
+				uint64_t *ai = &a[i * stride];
+				if(i != k && rf_bitrow_get(ai, k))
+					rf_bitrow_or(ai, ai, ak, stride);
+			}
+		}
+
+		size_t ones = 0;
+		for(size_t i = 0; i < n; i++)
+			ones += rf_bitrow_popcount(a[i * stride + kw] & mask);
+
+		if(table != NULL && 8 * ones > (256 + n) * (k1 - k0)) {
+			for(size_t w0 = 0; w0 < n_words; w0 += BLOCK_WORDS) {
+				product_m4r(a, stride, a, stride, k0, &a[k0 * stride], stride, n, k1 - k0,
+				            w0, MIN(BLOCK_WORDS, n_words - w0), table);
+			}
+			continue;
+		}
+
+		for(size_t i = 0; i < n; i++) {
+			if(i >= k0 && i < k1)
+				continue;
+			uint64_t *ai = &a[i * stride];
+			for(uint64_t bits = ai[kw] & mask; bits != 0; bits &= bits - 1) {
+				size_t k = kw * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+				rf_bitrow_or(ai, ai, &a[k * stride], stride);
+			}
+		}
+	}
+
+	rf_bitrow_free(table);
+}
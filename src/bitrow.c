@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L // posix_memalign
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "bitrow.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Number of words needed for a row of nbits bits, rounded up to whole cache lines.
+ */
+size_t
+rf_bitrow_words(size_t nbits) {
+	size_t words = (nbits + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+
+	return (words + RF_BITROW_LINE_WORDS-1) / RF_BITROW_LINE_WORDS * RF_BITROW_LINE_WORDS;
+}
+
+/*
+ * Allocates nwords zeroed words aligned to a cache line.
+ */
+uint64_t *
+rf_bitrow_alloc(size_t nwords) {
+	void *p = NULL;
+	size_t size = (nwords > 0 ? nwords : RF_BITROW_LINE_WORDS) * sizeof(uint64_t);
+	if(posix_memalign(&p, RF_BITROW_LINE_WORDS * sizeof(uint64_t), size) != 0)
+		return NULL;
+	memset(p, 0, size);
+
+	return p;
+}
+
+void
+rf_bitrow_free(uint64_t *row) {
+	free(row);
+}
+
+/*
+ * Sets bits [0, nbits) and leaves the padding untouched.
+ */
+void
+rf_bitrow_set_all(uint64_t *row, size_t nbits) {
+	assert(row != NULL);
+
+	size_t full = nbits / RF_BITROW_WORD_BITS;
+	for(size_t w = 0; w < full; w++)
+		row[w] = ~UINT64_C(0);
+	if(nbits % RF_BITROW_WORD_BITS != 0)
+		row[full] |= (UINT64_C(1) << (nbits % RF_BITROW_WORD_BITS)) - 1;
+}
+
+/*
+ * Flips bits [0, nbits); the padding stays clear.
+ */
+void
+rf_bitrow_not(uint64_t *row, size_t nbits) {
+	assert(row != NULL || nbits == 0);
+
+	size_t full = nbits / RF_BITROW_WORD_BITS;
+	for(size_t w = 0; w < full; w++)
+		row[w] = ~row[w];
+	if(nbits % RF_BITROW_WORD_BITS != 0)
+		row[full] ^= (UINT64_C(1) << (nbits % RF_BITROW_WORD_BITS)) - 1;
+}
+
+/*
+ * Number of set bits.
+ */
+size_t
+rf_bitrow_count(const uint64_t *row, size_t nwords) {
+	assert(row != NULL || nwords == 0);
+
+	size_t count = 0;
+	for(size_t w = 0; w < nwords; w++)
+		count += rf_bitrow_popcount(row[w]);
+
+	return count;
+}
+
+/*
+ * Index of the lowest bit set in a but not in b, RF_BITROW_NONE if a is a subset of
+ * b. Stops at the first word that differs.
+ */
+size_t
+rf_bitrow_first_andnot(const uint64_t *a, const uint64_t *b, size_t nwords) {
+	assert((a != NULL && b != NULL) || nwords == 0);
+
+	for(size_t w = 0; w < nwords; w++) {
+		uint64_t diff = a[w] & ~b[w];
+		if(diff != 0)
+			return w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(diff);
+	}
+
+	return RF_BITROW_NONE;
+}
+
+/*
+ * Index of the lowest set bit, RF_BITROW_NONE if the row is empty.
+ */
+size_t
+rf_bitrow_first(const uint64_t *row, size_t nwords) {
+	assert(row != NULL || nwords == 0);
+
+	for(size_t w = 0; w < nwords; w++) {
+		if(row[w] != 0)
+			return w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(row[w]);
+	}
+
+	return RF_BITROW_NONE;
+}
+
+/*
+ * Index of the highest set bit, RF_BITROW_NONE if the row is empty.
+ */
+size_t
+rf_bitrow_last(const uint64_t *row, size_t nwords) {
+	assert(row != NULL || nwords == 0);
+
+	for(size_t w = nwords; w-- > 0; ) {
+		if(row[w] != 0)
+			return w * RF_BITROW_WORD_BITS + rf_bitrow_msb(row[w]);
+	}
+
+	return RF_BITROW_NONE;
+}
+
+/*
+ * 64-bit hash of the row contents. Equal rows hash equal, so differing hashes
+ * rule out equality without comparing the rows.
+ */
+uint64_t
+rf_bitrow_hash(const uint64_t *row, size_t nwords) {
+	assert(row != NULL || nwords == 0);
+
+	uint64_t h = UINT64_C(0x9E3779B97F4A7C15);
+	for(size_t w = 0; w < nwords; w++) {
+		h = (h ^ row[w]) * UINT64_C(0xFF51AFD7ED558CCD);
+		h ^= h >> 32;
+	}
+
+	return h;
+}
+
+/*
+ * Adds row to a count of the rows seen so far per column, saturating at two:
+ * twice collects the bits row shares with seen, then seen takes all of row.
+ */
+void
+rf_bitrow_accumulate(uint64_t *seen, uint64_t *twice, const uint64_t *row, size_t nwords) {
+	assert((seen != NULL && twice != NULL && row != NULL) || nwords == 0);
+
+	for(size_t w = 0; w < nwords; w++) {
+		twice[w] |= seen[w] & row[w];
+		seen[w] |= row[w];
+	}
+}
+
+/*
+ * Defines a kernel dst[w] = a[w] OP b[w]. The SIMD loops cover the bulk of the
+ * row, the scalar loop the words left over (none for padded rows).
+ */
+#if defined(__AVX512F__)
+#define RF_BITROW_KERNEL(name, op512, op256, op128, scalar)                             \
+void                                                                                    \
+name(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords) {              \
+	size_t w = 0;                                                                   \
+	for(; w + 8 <= nwords; w += 8) {                                                \
+		__m512i va = _mm512_loadu_si512((const void *) &a[w]);                  \
+		__m512i vb = _mm512_loadu_si512((const void *) &b[w]);                  \
+		_mm512_storeu_si512((void *) &dst[w], op512(va, vb));                   \
+	}                                                                               \
+	for(; w < nwords; w++)                                                          \
+		dst[w] = scalar(a[w], b[w]);                                            \
+}
+#elif defined(__AVX2__)
+#define RF_BITROW_KERNEL(name, op512, op256, op128, scalar)                             \
+void                                                                                    \
+name(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords) {              \
+	size_t w = 0;                                                                   \
+	for(; w + 4 <= nwords; w += 4) {                                                \
+		__m256i va = _mm256_loadu_si256((const __m256i *) &a[w]);               \
+		__m256i vb = _mm256_loadu_si256((const __m256i *) &b[w]);               \
+		_mm256_storeu_si256((__m256i *) &dst[w], op256(va, vb));                \
+	}                                                                               \
+	for(; w < nwords; w++)                                                          \
+		dst[w] = scalar(a[w], b[w]);                                            \
+}
+#elif defined(__SSE2__)
+#define RF_BITROW_KERNEL(name, op512, op256, op128, scalar)                             \
+void                                                                                    \
+name(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords) {              \
+	size_t w = 0;                                                                   \
+	for(; w + 2 <= nwords; w += 2) {                                                \
+		__m128i va = _mm_loadu_si128((const __m128i *) &a[w]);                  \
+		__m128i vb = _mm_loadu_si128((const __m128i *) &b[w]);                  \
+		_mm_storeu_si128((__m128i *) &dst[w], op128(va, vb));                   \
+	}                                                                               \
+	for(; w < nwords; w++)                                                          \
+		dst[w] = scalar(a[w], b[w]);                                            \
+}
+#else
+#define RF_BITROW_KERNEL(name, op512, op256, op128, scalar)                             \
+void                                                                                    \
+name(uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t nwords) {              \
+	for(size_t w = 0; w < nwords; w++)                                              \
+		dst[w] = scalar(a[w], b[w]);                                            \
+}
+#endif
+
+#define RF_OR(a, b)     ((a) | (b))
+#define RF_AND(a, b)    ((a) & (b))
+#define RF_ANDNOT(a, b) ((a) & ~(b))
+// the intrinsics compute ~x & y, so the operands are swapped
+#define RF_ANDNOT512(a, b)      _mm512_andnot_si512((b), (a))
+#define RF_ANDNOT256(a, b)      _mm256_andnot_si256((b), (a))
+#define RF_ANDNOT128(a, b)      _mm_andnot_si128((b), (a))
+
+/*
+ * dst = a | b
+ */
+RF_BITROW_KERNEL(rf_bitrow_or, _mm512_or_si512, _mm256_or_si256, _mm_or_si128, RF_OR)
+
+/*
+ * dst = a & b
+ */
+RF_BITROW_KERNEL(rf_bitrow_and, _mm512_and_si512, _mm256_and_si256, _mm_and_si128, RF_AND)
+
+/*
+ * dst = a & ~b
+ */
+RF_BITROW_KERNEL(rf_bitrow_andnot, RF_ANDNOT512, RF_ANDNOT256, RF_ANDNOT128, RF_ANDNOT)
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "closure.h"
+
+/*
+ * Takes a copy of relation and closes it.
+ */
+rf_Closure *
+rf_closure_new(const rf_Relation *relation, rf_Error *error) {
+	assert(relation != NULL);
+
+	if(!rf_relation_is_homogeneous(relation)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return NULL;
+	}
+
+	rf_Closure *c = malloc(sizeof(*c));
+	c->relation = rf_relation_clone(relation);
+	c->pending = NULL;
+	c->n_pending = 0;
+	c->capacity = 0;
+
+	if(!rf_relation_make_transitive(c->relation, true, error)) {
+		rf_relation_free(c->relation);
+		free(c);
+		return NULL;
+	}
+
+	return c;
+}
+
+/*
+ * Adds (x, y) and keeps the relation closed: every row that reaches x, and row x
+ * itself, gains y and everything y reaches. Pending pairs are flushed first. Returns
+ * true if the relation changed.
+ */
+bool
+rf_closure_insert(rf_Closure *c, int x, int y) {
+	assert(c != NULL);
+
+	rf_closure_flush(c);
+
+	rf_Relation *r = c->relation;
+	const int dim = r->domains[0]->cardinality;
+	assert(x >= 0 && x < dim);
+	assert(y >= 0 && y < dim);
+
+	if(rf_relation_get(r, x, y))
+		return false;
+
+	// x may be reached by y, so row y changes on the way. Or it into row x first
+	// and propagate row x, which then holds everything x reaches.
+	uint64_t *rx = rf_relation_row(r, x);
+	rf_bitrow_or(rx, rx, rf_relation_row_const(r, y), r->stride);
+	rf_bitrow_set(rx, y);
+
+	for(int w = 0; w < dim; w++) {
+		uint64_t *rw = rf_relation_row(r, w);
+		if(w != x && rf_bitrow_get(rw, x))
+			rf_bitrow_or(rw, rw, rx, r->stride);
+	}
+	rf_relation_invalidate(r);
+
+	return true;
+}
+
+/*
+ * Records (x, y) for the next rf_closure_flush. The relation is not touched until
+ * then. Returns false if the pair could not be stored.
+ */
+bool
+rf_closure_defer(rf_Closure *c, int x, int y, rf_Error *error) {
+	assert(c != NULL);
+	assert(x >= 0 && x < c->relation->domains[0]->cardinality);
+	assert(y >= 0 && y < c->relation->domains[1]->cardinality);
+
+	if(c->n_pending == c->capacity) {
+		size_t capacity = c->capacity == 0 ? 16 : 2 * c->capacity;
+		int *pending = realloc(c->pending, 2 * capacity * sizeof(*pending));
+		if(pending == NULL) {
+			if(error != NULL)
+				rf_error_set(error, RF_E_NO_MEMORY, "");
+			return false;
+		}
+		c->pending = pending;
+		c->capacity = capacity;
+	}
+
+	c->pending[2 * c->n_pending] = x;
+	c->pending[2 * c->n_pending + 1] = y;
+	c->n_pending++;
+
+	return true;
+}
+
+/*
+ * Adds all pending pairs and closes the relation again. The relation was closed
+ * before, so every new path alternates between old pairs and new ones and only passes
+ * through endpoints of new pairs. Warshall with just those elements as pivots is
+ * therefore enough.
+ */
+void
+rf_closure_flush(rf_Closure *c) {
+	assert(c != NULL);
+
+	if(c->n_pending == 0)
+		return;
+
+	rf_Relation *r = c->relation;
+	const int dim = r->domains[0]->cardinality;
+
+	for(size_t i = 0; i < c->n_pending; i++)
+		rf_relation_set(r, c->pending[2 * i], c->pending[2 * i + 1], true);
+
+	uint64_t *pivots = rf_bitrow_alloc(r->stride);
+	if(pivots == NULL) {
+		rf_relation_make_transitive(r, true, NULL);
+		c->n_pending = 0;
+		return;
+	}
+	for(size_t i = 0; i < 2 * c->n_pending; i++)
+		rf_bitrow_set(pivots, c->pending[i]);
+
+	for(size_t kw = 0; kw < r->stride; kw++) {
+		for(uint64_t bits = pivots[kw]; bits != 0; bits &= bits - 1) {
+			const int k = kw * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+			const uint64_t *rk = rf_relation_row_const(r, k);
+			for(int w = 0; w < dim; w++) {
+				uint64_t *rw = rf_relation_row(r, w);
+				if(w != k && rf_bitrow_get(rw, k))
+					rf_bitrow_or(rw, rw, rk, r->stride);
+			}
+		}
+	}
+
+	rf_relation_invalidate(r);
+	rf_bitrow_free(pivots);
+	c->n_pending = 0;
+}
+
+/*
+ * Pairs still pending are not taken into account.
+ */
+bool
+rf_closure_get(const rf_Closure *c, int x, int y) {
+	assert(c != NULL);
+
+	return rf_relation_get(c->relation, x, y);
+}
+
+/*
+ * The closed relation, pending pairs are flushed first. It stays owned by c.
+ */
+const rf_Relation *
+rf_closure_get_relation(rf_Closure *c) {
+	assert(c != NULL);
+
+	rf_closure_flush(c);
+
+	return c->relation;
+}
+
+void
+rf_closure_free(rf_Closure *c) {
+	assert(c != NULL);
+
+	rf_relation_free(c->relation);
+	free(c->pending);
+	free(c);
+}
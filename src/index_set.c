@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "index_set.h"
+
+/*
+ * An empty set for the indices 0 .. capacity - 1, NULL if there is no memory for it.
+ */
+rf_IndexSet *
+rf_index_set_new(int capacity) {
+	assert(capacity >= 0);
+
+	rf_IndexSet *s = malloc(sizeof(*s));
+	s->capacity = capacity;
+	s->words = rf_bitrow_words(capacity);
+	s->bits = rf_bitrow_alloc(s->words);
+	if(s->bits == NULL) {
+		free(s);
+		return NULL;
+	}
+
+	return s;
+}
+
+/*
+ * The set of all indices 0 .. capacity - 1.
+ */
+rf_IndexSet *
+rf_index_set_new_full(int capacity) {
+	rf_IndexSet *s = rf_index_set_new(capacity);
+	if(s != NULL)
+		rf_bitrow_set_all(s->bits, capacity);
+
+	return s;
+}
+
+/*
+ * The indices of the members of subset in domain. Each member is looked up once.
+ * Returns NULL with RF_E_SET_NOT_SUBSET if one is missing from domain.
+ */
+rf_IndexSet *
+rf_index_set_new_from_set(const rf_Set *subset, const rf_Set *domain, rf_Error *error) {
+	assert(subset != NULL);
+	assert(domain != NULL);
+
+	rf_IndexSet *s = rf_index_set_new(domain->cardinality);
+	if(s == NULL) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
+
+	if(rf_index_set_add_set(s, subset, domain) != 0) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_SET_NOT_SUBSET, "");
+		rf_index_set_free(s);
+		return NULL;
+	}
+
+	return s;
+}
+
+rf_IndexSet *
+rf_index_set_clone(const rf_IndexSet *set) {
+	assert(set != NULL);
+
+	rf_IndexSet *s = rf_index_set_new(set->capacity);
+	if(s != NULL)
+		memcpy(s->bits, set->bits, set->words * sizeof(*set->bits));
+
+	return s;
+}
+
+void
+rf_index_set_clear(rf_IndexSet *set) {
+	assert(set != NULL);
+
+	memset(set->bits, 0, set->words * sizeof(*set->bits));
+}
+
+/*
+ * Adds the indices of the members of subset in domain, each looked up once. Returns
+ * the number of members missing from domain, which are skipped.
+ */
+int
+rf_index_set_add_set(rf_IndexSet *set, const rf_Set *subset, const rf_Set *domain) {
+	assert(set != NULL);
+	assert(subset != NULL);
+	assert(domain != NULL);
+	assert(set->capacity == (int) domain->cardinality);
+
+	int missing = 0;
+	for(int i = subset->cardinality-1; i >= 0; --i) {
+		const int index = rf_set_get_element_index(domain, subset->elements[i]);
+		if(index < 0)
+			missing++;
+		else
+			rf_index_set_add(set, index);
+	}
+
+	return missing;
+}
+
+int
+rf_index_set_count(const rf_IndexSet *set) {
+	assert(set != NULL);
+
+	return rf_bitrow_count(set->bits, set->words);
+}
+
+/*
+ * The least member not below from, -1 if there is none. Members are visited in order
+ * by for(i = rf_index_set_next(s, 0); i >= 0; i = rf_index_set_next(s, i + 1)).
+ */
+int
+rf_index_set_next(const rf_IndexSet *set, int from) {
+	assert(set != NULL);
+	assert(from >= 0);
+
+	if(from >= set->capacity)
+		return -1;
+
+	size_t w = from / RF_BITROW_WORD_BITS;
+	uint64_t bits = set->bits[w] & (~UINT64_C(0) << (from % RF_BITROW_WORD_BITS));
+	while(bits == 0) {
+		if(++w == set->words)
+			return -1;
+		bits = set->bits[w];
+	}
+
+	return w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+}
+
+/*
+ * The members as a new rf_Set of clones of the elements of domain, NULL if there is
+ * no memory.
+ */
+rf_Set *
+rf_index_set_to_set(const rf_IndexSet *set, const rf_Set *domain) {
+	assert(set != NULL);
+	assert(domain != NULL);
+	assert(set->capacity == (int) domain->cardinality);
+
+	const int n = rf_index_set_count(set);
+	rf_SetElement **elements = malloc((n > 0 ? n : 1) * sizeof(*elements));
+	if(elements == NULL)
+		return NULL;
+
+	int count = 0;
+	for(int i = rf_index_set_next(set, 0); i >= 0; i = rf_index_set_next(set, i + 1))
+		elements[count++] = rf_set_element_clone(domain->elements[i]);
+
+	rf_Set *s = rf_set_new(count, elements);
+	free(elements);
+
+	return s;
+}
+
+void
+rf_index_set_free(rf_IndexSet *set) {
+	assert(set != NULL);
+
+	rf_bitrow_free(set->bits);
+	free(set);
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "lattice.h"
+
+/*
+ * Fills the join and meet tables of l, pair by pair. Returns false as soon as a pair
+ * lacks a bound.
+ */
+static bool
+rf_lattice_tabulate(rf_Lattice *l) {
+	const int n = l->n;
+
+	l->join = malloc(((size_t) n * n > 0 ? (size_t) n * n : 1) * sizeof(*l->join));
+	l->meet = malloc(((size_t) n * n > 0 ? (size_t) n * n : 1) * sizeof(*l->meet));
+
+	for(int x = 0; x < n; x++) {
+		l->join[(size_t) x * n + x] = x;
+		l->meet[(size_t) x * n + x] = x;
+		for(int y = x + 1; y < n; y++) {
+			const int join = rf_poset_join(l->poset, x, y);
+			const int meet = rf_poset_meet(l->poset, x, y);
+			if(join < 0 || meet < 0)
+				return false;
+
+			l->join[(size_t) x * n + y] = l->join[(size_t) y * n + x] = join;
+			l->meet[(size_t) x * n + y] = l->meet[(size_t) y * n + x] = meet;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Prepares the lattice given by the partial order relation. Returns NULL with
+ * RF_E_REL_NOT_HOMOGENEOUS, RF_E_REL_NOT_ORDERED or RF_E_REL_NOT_LATTICE if relation
+ * is no lattice.
+ */
+rf_Lattice *
+rf_lattice_new(const rf_Relation *relation, rf_Error *error) {
+	assert(relation != NULL);
+
+	rf_Poset *poset = rf_poset_new(relation, error);
+	if(poset == NULL)
+		return NULL;
+
+	rf_Lattice *l = malloc(sizeof(*l));
+	l->n = poset->n;
+	l->poset = poset;
+	l->join = NULL;
+	l->meet = NULL;
+
+	// a lattice has a unique least and greatest element, first and last in the extension
+	l->bottom = l->n > 0 ? poset->order[0] : -1;
+	l->top = l->n > 0 ? poset->order[l->n - 1] : -1;
+
+	const bool lattice = l->n <= RF_LATTICE_TABLE_MAX
+	                     ? rf_lattice_tabulate(l)
+	                     : rf_poset_is_lattice(poset, NULL);
+	if(!lattice) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_LATTICE, "");
+		rf_lattice_free(l);
+		return NULL;
+	}
+
+	return l;
+}
+
+/*
+ * The supremum of the elements x and y.
+ */
+int
+rf_lattice_join(const rf_Lattice *l, int x, int y) {
+	assert(l != NULL);
+	assert(x >= 0 && x < l->n && y >= 0 && y < l->n);
+
+	if(l->join != NULL)
+		return l->join[(size_t) x * l->n + y];
+	return rf_poset_join(l->poset, x, y);
+}
+
+/*
+ * The infimum of the elements x and y.
+ */
+int
+rf_lattice_meet(const rf_Lattice *l, int x, int y) {
+	assert(l != NULL);
+	assert(x >= 0 && x < l->n && y >= 0 && y < l->n);
+
+	if(l->meet != NULL)
+		return l->meet[(size_t) x * l->n + y];
+	return rf_poset_meet(l->poset, x, y);
+}
+
+/*
+ * The supremum of count elements, the least element for none.
+ */
+int
+rf_lattice_join_all(const rf_Lattice *l, int count, const int *elements) {
+	assert(l != NULL);
+	assert(count >= 0 && (count == 0 || elements != NULL));
+
+	int join = l->bottom;
+	for(int i = 0; i < count; i++)
+		join = rf_lattice_join(l, join, elements[i]);
+
+	return join;
+}
+
+/*
+ * The infimum of count elements, the greatest element for none.
+ */
+int
+rf_lattice_meet_all(const rf_Lattice *l, int count, const int *elements) {
+	assert(l != NULL);
+	assert(count >= 0 && (count == 0 || elements != NULL));
+
+	int meet = l->top;
+	for(int i = 0; i < count; i++)
+		meet = rf_lattice_meet(l, meet, elements[i]);
+
+	return meet;
+}
+
+void
+rf_lattice_free(rf_Lattice *l) {
+	assert(l != NULL);
+
+	free(l->meet);
+	free(l->join);
+	rf_poset_free(l->poset);
+	free(l);
+}
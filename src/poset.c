@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "poset.h"
+#include "bitrow.h"
+
+/*
+ * Builds the up- and down-sets of a partial order. Sorting by the size of the
+ * down-set gives a linear extension: x strictly below z has a strictly smaller one.
+ * Returns NULL with RF_E_REL_NOT_HOMOGENEOUS or RF_E_REL_NOT_ORDERED if relation is
+ * no partial order.
+ */
+rf_Poset *
+rf_poset_new(const rf_Relation *relation, rf_Error *error) {
+	assert(relation != NULL);
+
+	if(!rf_relation_is_homogeneous(relation)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return NULL;
+	}
+	if(!rf_relation_is_partial_order(relation)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_ORDERED, "");
+		return NULL;
+	}
+
+	const int n = relation->domains[0]->cardinality;
+	rf_Poset *p = malloc(sizeof(*p));
+	p->n = n;
+	p->order = malloc((n > 0 ? n : 1) * sizeof(*p->order));
+	p->position = malloc((n > 0 ? n : 1) * sizeof(*p->position));
+	p->stride = rf_bitrow_words(n);
+	p->up = rf_bitrow_alloc((size_t) n * p->stride);
+	p->down = rf_bitrow_alloc((size_t) n * p->stride);
+	p->bounds = rf_bitrow_alloc(p->stride);
+
+	// counting sort by down-set size, 1 .. n for a reflexive relation
+	int *first = calloc(n + 2, sizeof(*first));
+	for(int x = 0; x < n; x++) {
+		p->position[x] = rf_bitrow_count(rf_relation_row_const(relation, x), relation->stride);
+		first[p->position[x] + 1]++;
+	}
+	for(int size = 1; size <= n + 1; size++)
+		first[size] += first[size - 1];
+	for(int x = 0; x < n; x++) {
+		const int i = first[p->position[x]]++;
+		p->order[i] = x;
+		p->position[x] = i;
+	}
+	free(first);
+
+	for(int x = 0; x < n; x++) {
+		const uint64_t *rx = rf_relation_row_const(relation, x);
+		const size_t px = p->position[x];
+		for(size_t w = 0; w < relation->stride; w++) {
+			for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1) {
+				const size_t py = p->position[w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits)];
+				rf_bitrow_set(&p->down[px * p->stride], py);
+				rf_bitrow_set(&p->up[py * p->stride], px);
+			}
+		}
+	}
+
+	return p;
+}
+
+/*
+ * Position of the least element of the up-set intersection of the positions px and
+ * py, if the lowest one is below all others; -1 otherwise. bounds is scratch space
+ * of stride words.
+ */
+static int
+rf_poset_join_position(const rf_Poset *p, size_t px, size_t py, uint64_t *bounds) {
+	rf_bitrow_and(bounds, &p->up[px * p->stride], &p->up[py * p->stride], p->stride);
+
+	const size_t least = rf_bitrow_first(bounds, p->stride);
+	if(least == RF_BITROW_NONE)
+		return -1;
+	if(rf_bitrow_first_andnot(bounds, &p->up[least * p->stride], p->stride) != RF_BITROW_NONE)
+		return -1;
+
+	return least;
+}
+
+/*
+ * Position of the greatest element of the down-set intersection, like
+ * rf_poset_join_position.
+ */
+static int
+rf_poset_meet_position(const rf_Poset *p, size_t px, size_t py, uint64_t *bounds) {
+	rf_bitrow_and(bounds, &p->down[px * p->stride], &p->down[py * p->stride], p->stride);
+
+	const size_t greatest = rf_bitrow_last(bounds, p->stride);
+	if(greatest == RF_BITROW_NONE)
+		return -1;
+	if(rf_bitrow_first_andnot(bounds, &p->down[greatest * p->stride], p->stride) != RF_BITROW_NONE)
+		return -1;
+
+	return greatest;
+}
+
+/*
+ * The supremum of the elements x and y, -1 if there is none.
+ */
+int
+rf_poset_join(const rf_Poset *p, int x, int y) {
+	assert(p != NULL);
+	assert(x >= 0 && x < p->n && y >= 0 && y < p->n);
+
+	const int join = rf_poset_join_position(p, p->position[x], p->position[y], p->bounds);
+
+	return join < 0 ? -1 : p->order[join];
+}
+
+/*
+ * The infimum of the elements x and y, -1 if there is none.
+ */
+int
+rf_poset_meet(const rf_Poset *p, int x, int y) {
+	assert(p != NULL);
+	assert(x >= 0 && x < p->n && y >= 0 && y < p->n);
+
+	const int meet = rf_poset_meet_position(p, p->position[x], p->position[y], p->bounds);
+
+	return meet < 0 ? -1 : p->order[meet];
+}
+
+/*
+ * Whether every pair of elements has a supremum and an infimum, O(n^3 / 64). If not
+ * and pair is given, it receives the first such pair x < y lacking one.
+ */
+bool
+rf_poset_is_lattice(const rf_Poset *p, int pair[2]) {
+	assert(p != NULL);
+
+	bool lattice = true;
+
+	for(int x = 0; x < p->n && lattice; x++) {
+		for(int y = x + 1; y < p->n && lattice; y++) {
+			const size_t px = p->position[x];
+			const size_t py = p->position[y];
+			lattice = rf_poset_join_position(p, px, py, p->bounds) >= 0
+			          && rf_poset_meet_position(p, px, py, p->bounds) >= 0;
+			if(!lattice && pair != NULL) {
+				pair[0] = x;
+				pair[1] = y;
+			}
+		}
+	}
+
+	return lattice;
+}
+
+void
+rf_poset_free(rf_Poset *p) {
+	assert(p != NULL);
+
+	rf_bitrow_free(p->bounds);
+	rf_bitrow_free(p->down);
+	rf_bitrow_free(p->up);
+	free(p->position);
+	free(p->order);
+	free(p);
+}
@@ -19,39 +19,26 @@
 
 #include <stdlib.h>
 #include <stdio.h>
-#include <stdarg.h>
 #include <string.h>
+#include <stdarg.h>
 #include <assert.h>
 
 #include "relation.h"
+#include "bitmatrix.h"
+#include "sparse_relation.h"
+#include "union_find.h"
+#include "poset.h"
 #include "tools.h"
 
 #define N_DOMAINS 2
 
 /*
- * table[x][y][z] = x * r->domains[0]->cardinality + y * r->domains[1]->cardinality + z
+ * make_transitive closes relations of at least SPARSE_CLOSURE_MIN_DIM elements with at
+ * most SPARSE_CLOSURE_MAX_DEGREE pairs per element on average on their strongly
+ * connected components instead of the bit table.
  */
-size_t
-rf_table_idx(const rf_Relation *r, ...) {
-	assert(r != NULL);
-
-	size_t idx = 0;
-	va_list argv;
-	va_start(argv, r);
-	int i;
-	int offset;
-	for(i = 0; i < N_DOMAINS-1; ++i) {
-		offset = va_arg(argv, int);
-		assert(offset < r->domains[i]->cardinality);
-		idx += r->domains[i]->cardinality * offset;
-	}
-	offset = va_arg(argv, int);
-	assert(offset < r->domains[i]->cardinality);
-	idx += offset;
-	va_end(argv);
-
-	return idx;
-}
+#define SPARSE_CLOSURE_MIN_DIM          256
+#define SPARSE_CLOSURE_MAX_DEGREE       8
 
 bool
 rf_relation_calc(rf_Relation *r, rf_SetElement *e1, rf_SetElement *e2, rf_Error *error) {
@@ -70,33 +57,122 @@ rf_relation_calc(rf_Relation *r, rf_SetElement *e1, rf_SetElement *e2, rf_Error
 		return false;
 	}
 
-	return r->table[rf_table_idx(r, x, y)];
+	return rf_relation_get(r, x, y);
+}
+
+
+/*
+ * Number of words in r->table, every row is padded to whole cache lines.
+ */
+static size_t
+rf_table_words(const rf_Relation *r) {
+	return (size_t) r->domains[0]->cardinality * r->stride;
+}
+
+/*
+ * Frees what a relation holds outside its arena: the aligned table, the caches and
+ * the tracker.
+ */
+static void
+rf_relation_release(void *object) {
+	rf_Relation *r = object;
+
+	rf_bitrow_free(r->table);
+	rf_bitrow_free(r->transpose);
+	rf_relation_untrack(r);
 }
 
+/*
+ * Creates a relation with an all zero table. With an arena, the relation and the
+ * copies of the domains are made in it. NULL if there is no memory for the relation,
+ * its domains, its table or noting its release.
+ */
+static rf_Relation *
+rf_relation_alloc(rf_Arena *arena, rf_Set *d1, rf_Set *d2) {
+	rf_Relation *r = rf_arena_alloc(arena, sizeof(*r));
+	rf_Set **domains = arena != NULL ? rf_arena_alloc(arena, N_DOMAINS * sizeof(*domains)) : calloc(N_DOMAINS, sizeof(*domains));
+	if(r == NULL || domains == NULL) {
+		if(arena == NULL) {
+			free(domains);
+			free(r);
+		}
+		return NULL;
+	}
+	r->domains = domains;
+	r->domains[0] = rf_set_clone_in(arena, d1);
+	r->domains[1] = rf_set_clone_in(arena, d2);
+	r->stride = rf_bitrow_words(d2->cardinality);
+	r->table = rf_bitrow_alloc(rf_table_words(r));
+	r->known = 0;
+	r->properties = 0;
+	r->tracker = NULL;
+	r->transpose = NULL;
+	r->transposed = false;
+	r->in_arena = arena != NULL;
+
+	if(r->domains[0] == NULL || r->domains[1] == NULL || r->table == NULL
+	   || (arena != NULL && !rf_arena_defer(arena, rf_relation_release, r))) {
+		// domains in the arena go with it
+		rf_relation_release(r);
+		if(arena == NULL) {
+			for(int i = N_DOMAINS-1; i >= 0; --i) {
+				if(r->domains[i] != NULL)
+					rf_set_free(r->domains[i]);
+			}
+			free(r->domains);
+			free(r);
+		}
+		return NULL;
+	}
 
+	return r;
+}
 
+/*
+ * table is a row-major array of d1->cardinality * d2->cardinality booleans
+ */
 rf_Relation *
 rf_relation_new(rf_Set *d1, rf_Set *d2, bool *table) {
+	return rf_relation_new_in(NULL, d1, d2, table);
+}
+
+rf_Relation *
+rf_relation_new_in(rf_Arena *arena, rf_Set *d1, rf_Set *d2, bool *table) {
 	assert(d1 != NULL);
 	assert(d2 != NULL);
 	assert(table != NULL);
 
-	rf_Relation *r = malloc(sizeof(*r));
-	r->domains = calloc(N_DOMAINS, sizeof(*r->domains));
-	r->domains[0] = rf_set_clone(d1);
-	r->domains[1] = rf_set_clone(d2);
-	size_t table_size = d1->cardinality * d2->cardinality;
-	r->table = calloc(table_size, sizeof(*r->table));
-	memcpy(r->table, table, table_size);
+	rf_Relation *r = rf_relation_alloc(arena, d1, d2);
+	if(r == NULL)
+		return NULL;
+
+	const int dim1 = d1->cardinality;
+	const int dim2 = d2->cardinality;
+	for(int x = dim1-1; x >= 0; --x) {
+		for(int y = dim2-1; y >= 0; --y) {
+			if(table[x * dim2 + y])
+				rf_relation_set(r, x, y, true);
+		}
+	}
 
 	return r;
 }
 
 rf_Relation *
 rf_relation_clone(const rf_Relation *r) {
+	return rf_relation_clone_in(NULL, r);
+}
+
+rf_Relation *
+rf_relation_clone_in(rf_Arena *arena, const rf_Relation *r) {
 	assert(r != NULL);
 
-	rf_Relation *new = rf_relation_new(r->domains[0], r->domains[1], r->table);
+	rf_Relation *new = rf_relation_alloc(arena, r->domains[0], r->domains[1]);
+	if(new == NULL)
+		return NULL;
+	memcpy(new->table, r->table, rf_table_words(r) * sizeof(*r->table));
+	new->known = r->known;
+	new->properties = r->properties;
 
 	return new;
 }
@@ -104,44 +180,54 @@ rf_relation_clone(const rf_Relation *r) {
 
 rf_Relation *
 rf_relation_new_empty(rf_Set *d1, rf_Set *d2) {
+	return rf_relation_new_empty_in(NULL, d1, d2);
+}
+
+rf_Relation *
+rf_relation_new_empty_in(rf_Arena *arena, rf_Set *d1, rf_Set *d2) {
 	assert(d1 != NULL);
 	assert(d2 != NULL);
 
-	size_t table_size = d1->cardinality * d2->cardinality;
-	bool table[table_size];
-
-	rf_Relation *new = rf_relation_new(d1, d2, table);
-	memset(new->table, false, table_size);
-
-	return new;
+	return rf_relation_alloc(arena, d1, d2);
 }
 
 rf_Relation *
 rf_relation_new_full(rf_Set *d1, rf_Set *d2) {
+	return rf_relation_new_full_in(NULL, d1, d2);
+}
+
+rf_Relation *
+rf_relation_new_full_in(rf_Arena *arena, rf_Set *d1, rf_Set *d2) {
 	assert(d1 != NULL);
 	assert(d2 != NULL);
 
-	size_t table_size = d1->cardinality * d2->cardinality;
-	bool table[table_size];
+	rf_Relation *new = rf_relation_alloc(arena, d1, d2);
+	if(new == NULL)
+		return NULL;
 
-	rf_Relation *new = rf_relation_new(d1, d2, table);
-	memset(new->table, true, table_size);
+	for(int x = d1->cardinality-1; x >= 0; --x) {
+		rf_bitrow_set_all(rf_relation_row(new, x), d2->cardinality);
+	}
 
 	return new;
 }
 
 rf_Relation *
 rf_relation_new_id(rf_Set *d) {
-	assert(d != NULL);
+	return rf_relation_new_id_in(NULL, d);
+}
 
-	size_t table_size = d->cardinality * d->cardinality;
-	bool table[table_size];
+rf_Relation *
+rf_relation_new_id_in(rf_Arena *arena, rf_Set *d) {
+	assert(d != NULL);
 
-	rf_Relation *new = rf_relation_new_empty(d, d);
+	rf_Relation *new = rf_relation_new_empty_in(arena, d, d);
+	if(new == NULL)
+		return NULL;
 
 	const int dim = new->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
-		new->table[rf_table_idx(new, x, x)] = true;
+		rf_relation_set(new, x, x, true);
 	}
 
 	return new;
@@ -150,14 +236,21 @@ rf_relation_new_id(rf_Set *d) {
 // includes the (x,x) elements
 rf_Relation *
 rf_relation_new_top(rf_Set *d) {
+	return rf_relation_new_top_in(NULL, d);
+}
+
+rf_Relation *
+rf_relation_new_top_in(rf_Arena *arena, rf_Set *d) {
 	assert(d != NULL);
 
-	rf_Relation *new = rf_relation_new_empty(d, d);
+	rf_Relation *new = rf_relation_new_empty_in(arena, d, d);
+	if(new == NULL)
+		return NULL;
 
 	const int dim = new->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
 		for(int y = dim-1; y >= x; --y) {
-			new->table[rf_table_idx(new, x, y)] = true;
+			rf_relation_set(new, x, y, true);
 		}
 	}
 
@@ -167,67 +260,131 @@ rf_relation_new_top(rf_Set *d) {
 // includes the (x,x) elements
 rf_Relation *
 rf_relation_new_bottom(rf_Set *d) {
+	return rf_relation_new_bottom_in(NULL, d);
+}
+
+rf_Relation *
+rf_relation_new_bottom_in(rf_Arena *arena, rf_Set *d) {
 	assert(d != NULL);
 
-	rf_Relation *new = rf_relation_new_empty(d, d);
+	rf_Relation *new = rf_relation_new_empty_in(arena, d, d);
+	if(new == NULL)
+		return NULL;
 
 	const int dim = new->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
 		for(int y = x; y >= 0; --y) {
-			new->table[rf_table_idx(new, x, y)] = true;
+			rf_relation_set(new, x, y, true);
 		}
 	}
 
 	return new;
 }
 
-rf_Relation *
-rf_relation_new_union(rf_Relation *r1, rf_Relation *r2, rf_Error *error) {
-	assert(r1 != NULL);
-	assert(r2 != NULL);
+/*
+ * Checks whether both sets hold equal elements at equal positions.
+ */
+static bool
+rf_set_equal_ordered(const rf_Set *a, const rf_Set *b) {
+	if(a->cardinality != b->cardinality)
+		return false;
+
+	for(int i = a->cardinality-1; i >= 0; --i)
+		if(!rf_set_element_equal(a->elements[i], b->elements[i]))
+			return false;
+
+	return true;
+}
+
+/*
+ * Returns r laid out over the domains d1 and d2, so its table can be combined word by
+ * word with another table over them. That is r itself if the elements are in the
+ * same order, a reordered copy (which the caller must free) if the domains are equal
+ * but ordered differently, or NULL with error set if the domains differ (to mismatch)
+ * or there is no memory.
+ */
+static rf_Relation *
+rf_relation_aligned_to(const rf_Relation *r, const rf_Set *d1, const rf_Set *d2, char *mismatch, rf_Error *error) {
+	const rf_Set *like[N_DOMAINS] = { d1, d2 };
 
+	bool ordered = true;
 	for(int i = N_DOMAINS-1; i >= 0; --i) {
-		if(!rf_set_equal(r1->domains[i], r2->domains[i])) {
-			if(error != NULL) {
-				rf_error_set(error, RF_E_GENERIC, "Domains of r1 and r2 differ");
-			}
+		if(rf_set_equal_ordered(r->domains[i], like[i]))
+			continue;
+		if(!rf_set_equal(r->domains[i], like[i])) {
+			if(error != NULL)
+				rf_error_set(error, RF_E_GENERIC, mismatch);
 			return NULL;
 		}
+		ordered = false;
+	}
+	if(ordered)
+		return (rf_Relation *) r;
+
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	rf_Relation *new = rf_relation_alloc(NULL, (rf_Set *) d1, (rf_Set *) d2);
+	int *ys = malloc((dim2 > 0 ? dim2 : 1) * sizeof(*ys));
+	if(new == NULL || ys == NULL) {
+		if(new != NULL)
+			rf_relation_free(new);
+		free(ys);
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
 	}
-
-	rf_Relation *new = rf_relation_new_empty(r1->domains[0], r1->domains[1]);
-
-	const int dim = new->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		for(int y = dim-1; y >= 0; --y) {
-			new->table[rf_table_idx(new, x, y)] = r1->table[rf_table_idx(r1, x, y)] || r2->table[rf_table_idx(r2, x, y)];
+	for(int y = dim2-1; y >= 0; --y)
+		ys[y] = rf_set_get_element_index(d2, r->domains[1]->elements[y]);
+	for(int x = dim1-1; x >= 0; --x) {
+		int xl = rf_set_get_element_index(d1, r->domains[0]->elements[x]);
+		for(int y = dim2-1; y >= 0; --y) {
+			if(rf_relation_get(r, x, y))
+				rf_relation_set(new, xl, ys[y], true);
 		}
 	}
+	free(ys);
 
 	return new;
 }
 
+static rf_Relation *
+rf_relation_aligned(const rf_Relation *r, const rf_Relation *like, rf_Error *error) {
+	return rf_relation_aligned_to(r, like->domains[0], like->domains[1], "Domains of r1 and r2 differ", error);
+}
+
 rf_Relation *
-rf_relation_new_intersection(rf_Relation *r1, rf_Relation *r2, rf_Error *error) {
+rf_relation_new_union(rf_Relation *r1, rf_Relation *r2, rf_Error *error) {
 	assert(r1 != NULL);
 	assert(r2 != NULL);
 
-	for(int i = N_DOMAINS-1; i >= 0; --i) {
-		if(!rf_set_equal(r1->domains[i], r2->domains[i])) {
-			if(error != NULL) {
-				rf_error_set(error, RF_E_GENERIC, "Domains of r1 and r2 differ");
-			}
-			return NULL;
-		}
+	rf_Relation *new = rf_relation_clone(r1);
+	if(new == NULL) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
+	if(!rf_relation_make_union(new, r2, error)) {
+		rf_relation_free(new);
+		return NULL;
 	}
 
-	rf_Relation *new = rf_relation_new_empty(r1->domains[0], r1->domains[1]);
+	return new;
+}
 
-	const int dim = new->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		for(int y = dim-1; y >= 0; --y) {
-			new->table[rf_table_idx(new, x, y)] = r1->table[rf_table_idx(r1, x, y)] && r2->table[rf_table_idx(r2, x, y)];
-		}
+rf_Relation *
+rf_relation_new_intersection(rf_Relation *r1, rf_Relation *r2, rf_Error *error) {
+	assert(r1 != NULL);
+	assert(r2 != NULL);
+
+	rf_Relation *new = rf_relation_clone(r1);
+	if(new == NULL) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
+	if(!rf_relation_make_intersection(new, r2, error)) {
+		rf_relation_free(new);
+		return NULL;
 	}
 
 	return new;
@@ -238,40 +395,55 @@ rf_relation_new_complement(rf_Relation *r, rf_Error *error) {
 	assert(r != NULL);
 
 	rf_Relation *new = rf_relation_clone(r);
-
-	const size_t table_size = new->domains[0]->cardinality * new->domains[1]->cardinality;
-	for(int i = table_size-1; i >= 0; --i) {
-		new->table[i] = !new->table[i];
+	if(new == NULL) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
+	if(!rf_relation_make_complement(new, error)) {
+		rf_relation_free(new);
+		return NULL;
 	}
 
 	return new;
 }
 
+/*
+ * r1 ; r2 = { (x, z) | xR1y & yR2z }, computed as a boolean matrix product.
+ * r1 may be a relation between A and B, r2 between B and C.
+ */
 rf_Relation *
 rf_relation_new_concatenation(rf_Relation *r1, rf_Relation *r2, rf_Error *error) {
 	assert(r1 != NULL);
 	assert(r2 != NULL);
 
-	if(!rf_set_equal(r1->domains[1], r2->domains[0])) {
-		if(error != NULL) {
-			rf_error_set(error, RF_E_GENERIC, "Domains of r1->domain1 and r2->domain0 differ");
-		}
+	rf_Relation *other = rf_relation_aligned_to(r2, r1->domains[1], r2->domains[1], "Domains of r1->domain1 and r2->domain0 differ", error);
+	if(other == NULL)
 		return NULL;
-	}
 
 	rf_Relation *new = rf_relation_new_empty(r1->domains[0], r2->domains[1]);
+	if(new == NULL) {
+		if(other != r2)
+			rf_relation_free(other);
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
 
-	for(int x = r1->domains[1]->cardinality-1; x >= 0; --x) {
-		for(int y = r1->domains[0]->cardinality-1; y >= 0; --y) {
-			if(!r1->table[rf_table_idx(r1, x, y)])
-				continue;
+	bool ok = rf_bitmatrix_product(new->table, new->stride,
+	                               r1->table, r1->stride,
+	                               other->table, other->stride,
+	                               r1->domains[0]->cardinality,
+	                               r1->domains[1]->cardinality,
+	                               r2->domains[1]->cardinality);
 
-			for(int z = r2->domains[1]->cardinality-1; z >= 0; --z) {
-				if(r2->table[rf_table_idx(r2, y,z)]) {
-						new->table[rf_table_idx(new,x,z)] = true;
-				}
-			}
-		}
+	if(other != r2)
+		rf_relation_free(other);
+	if(!ok) {
+		rf_relation_free(new);
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
 	}
 
 	return new;
@@ -281,20 +453,15 @@ rf_Relation *
 rf_relation_new_converse(const rf_Relation *r, rf_Error *error) {
 	assert(r != NULL);
 
-	if(!rf_relation_is_homogeneous(r)) {
+	rf_Relation *new = rf_relation_alloc(NULL, r->domains[1], r->domains[0]);
+	if(new == NULL) {
 		if(error != NULL)
-			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+			rf_error_set(error, RF_E_NO_MEMORY, "");
 		return NULL;
 	}
 
-	rf_Relation *new = rf_relation_new_empty(r->domains[0], r->domains[1]);
-
-	const int dim = new->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		for(int y = dim-1; y >= 0; --y) {
-			new->table[rf_table_idx(new, x, y)] = r->table[rf_table_idx(r, y, x)];
-		}
-	}
+	rf_bitmatrix_transpose(new->table, new->stride, r->table, r->stride,
+	                       r->domains[0]->cardinality, r->domains[1]->cardinality);
 
 	return new;
 }
@@ -308,11 +475,11 @@ rf_relation_new_subsetleq(rf_Set *d, rf_Error *error) {
 		if(d->elements[x]->type == RF_SET_ELEMENT_TYPE_SET) {
 			for(int y = 0; y < d->cardinality; y++) {
 				if(x == y) {
-					subsetleq->table[rf_table_idx(subsetleq,x,y)] = true;
+					rf_relation_set(subsetleq, x, y, true);
 				} else if(d->elements[y]->type == RF_SET_ELEMENT_TYPE_SET) {
 					rf_Set *set1 = d->elements[y]->value.set;
 					rf_Set *set2 = d->elements[x]->value.set;
-					subsetleq->table[rf_table_idx(subsetleq,x,y)] = rf_set_is_subset(set1, set2);
+					rf_relation_set(subsetleq, x, y, rf_set_is_subset(set1, set2));
 				}
 			}
 		}
@@ -322,240 +489,1446 @@ rf_relation_new_subsetleq(rf_Set *d, rf_Error *error) {
 }
 
 
-bool
-rf_relation_is_homogeneous(const rf_Relation *r) {
-	assert(r != NULL);
+/*
+ * Properties that only homogeneous relations can have, the ones checked while
+ * walking the rows, and the ones that need the columns as well. Surjectivity and
+ * injectivity are row properties: the rows are ORed into the columns seen once and
+ * twice on the way.
+ */
+#define HOMOGENEOUS_PROPERTIES  (RF_PROPERTY_REFLEXIVE | RF_PROPERTY_IRREFLEXIVE | RF_PROPERTY_SYMMETRIC \
+                                 | RF_PROPERTY_ANTISYMMETRIC | RF_PROPERTY_TRANSITIVE | RF_PROPERTY_DIFUNCTIONAL)
+#define SEEN_PROPERTIES         (RF_PROPERTY_SURJECTIVE | RF_PROPERTY_INJECTIVE)
+#define ROW_PROPERTIES          (HOMOGENEOUS_PROPERTIES | RF_PROPERTY_LEFTTOTAL | RF_PROPERTY_FUNCTIONAL \
+                                 | SEEN_PROPERTIES)
+#define COLUMN_PROPERTIES       (RF_PROPERTY_SYMMETRIC | RF_PROPERTY_ANTISYMMETRIC)
 
-	for(int i = N_DOMAINS-2; i >= 0; --i)
-		if(!rf_set_equal(r->domains[i], r->domains[i+1]))
-			return false;
+/*
+ * Word w of column y, the bits 64w .. 64w+63 of { x | xRy }. Taken from the transpose
+ * t if there is one, gathered from the rows otherwise.
+ */
+static uint64_t
+column_word(const rf_Relation *r, const uint64_t *t, size_t t_stride, int y, size_t w) {
+	if(t != NULL)
+		return t[(size_t) y * t_stride + w];
 
-	return true;
+	const size_t dim1 = r->domains[0]->cardinality;
+	uint64_t word = 0;
+	for(size_t i = 0; i < RF_BITROW_WORD_BITS && w * RF_BITROW_WORD_BITS + i < dim1; i++) {
+		if(rf_relation_get(r, w * RF_BITROW_WORD_BITS + i, y))
+			word |= UINT64_C(1) << i;
+	}
+
+	return word;
 }
 
-// xRy => !yRx
-bool
-rf_relation_is_antisymmetric(const rf_Relation *r) {
-	assert(r != NULL);
+/*
+ * The table of the converse of r, dim2 rows of rf_bitrow_words(dim1) words, for use
+ * with column_word. NULL if there is no memory for it.
+ */
+static uint64_t *
+rf_relation_transpose_table(const rf_Relation *r) {
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	const size_t t_stride = rf_bitrow_words(dim1);
 
-	if(!rf_relation_is_homogeneous(r))
-		return false;
+	uint64_t *t = rf_bitrow_alloc((size_t) dim2 * t_stride);
+	if(t != NULL)
+		rf_bitmatrix_transpose(t, t_stride, r->table, r->stride, dim1, dim2);
 
-	const int dim = r->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		for(int y = dim-1; y > x; --y) {
-			if(r->table[rf_table_idx(r, x, y)] && r->table[rf_table_idx(r, y, x)])
-				return false;
-			// xRy exists but yRx doesn't or yRx exists but xRy doesn't
-		}
-	}
-	return true;
+	return t;
 }
 
-bool
-rf_relation_is_asymmetric(const rf_Relation *r) {
-	assert(r != NULL);
+/*
+ * The transpose of r, cached until the table changes. NULL if there is no memory for
+ * it. Like the property cache it does not count as part of the value of r.
+ */
+static const uint64_t *
+rf_relation_transpose_cached(const rf_Relation *r) {
+	rf_Relation *cache = (rf_Relation *) r;
 
-	return !rf_relation_is_reflexive(r) && rf_relation_is_antisymmetric(r);
-}
+	if(!r->transposed) {
+		rf_bitrow_free(cache->transpose);
+		cache->transpose = rf_relation_transpose_table(r);
+		cache->transposed = cache->transpose != NULL;
+	}
 
-// xRy & zRy & zRw => xRw
-bool
-rf_relation_is_difunctional(const rf_Relation *r) {
-	assert(r != NULL);
+	return r->transpose;
+}
 
-	if(!rf_relation_is_homogeneous(r))
-		return false;
+/*
+ * State of the difunctionality check over the rows in order. owner[y] is the first
+ * row found with xRy, hashes[x] the hash of row x. Both are NULL if there is no
+ * memory for them.
+ */
+typedef struct {
+	int           *owner;
+	uint64_t      *hashes;
+} rf_RowClasses;
+
+static void
+rf_row_classes_destroy(rf_RowClasses *c) {
+	free(c->hashes);
+	free(c->owner);
+	c->hashes = NULL;
+	c->owner = NULL;
+}
 
-	const int dim = r->domains[0]->cardinality;
+static void
+rf_row_classes_init(rf_RowClasses *c, const rf_Relation *r) {
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	c->owner = malloc((dim2 > 0 ? dim2 : 1) * sizeof(*c->owner));
+	c->hashes = malloc((dim1 > 0 ? dim1 : 1) * sizeof(*c->hashes));
+	if(c->owner == NULL || c->hashes == NULL) {
+		rf_row_classes_destroy(c);
+		return;
+	}
+	for(int y = 0; y < dim2; y++)
+		c->owner[y] = -1;
+}
 
-	for(int y = 0; y < dim; y++) {
-		for(int x = 0; x < dim; x++) {
-			if(r->table[rf_table_idx(r,x,y)]) {
-				for(int z=x+1;z<dim;z++) {
-					if(r->table[rf_table_idx(r,z,y)]) {
-						//here we have xRy & zRy, now we test for the images of x and z
-						for(int i = 0;i<dim;i++) {
-							if(r->table[rf_table_idx(r,z,i)] != r->table[rf_table_idx(r,x,i)]) {
-								return false;
-							}
-						}
-					}
-				}
+/*
+ * R is difunctional iff any two rows are equal or disjoint. Row x, visited after
+ * all rows before it, passes if its first column is owned by an equal row or if it
+ * owns all its columns itself. Otherwise returns the earlier row z sharing column
+ * *y with it without being equal, -1 if it passes. Each column is owned once and
+ * each row compared once, O(n^2 / 64) for all rows. Without memory for the classes
+ * row x is compared with every row before it, O(n^3 / 64) for all rows.
+ */
+static int
+rf_row_classes_add(rf_RowClasses *c, const rf_Relation *r, int x, int *y) {
+	const uint64_t *rx = rf_relation_row_const(r, x);
+	const size_t words = r->stride;
+
+	if(c->owner == NULL) {
+		for(int z = 0; z < x; z++) {
+			const uint64_t *rz = rf_relation_row_const(r, z);
+			for(size_t w = 0; w < words; w++) {
+				const uint64_t both = rx[w] & rz[w];
+				if(both == 0)
+					continue;
+				if(memcmp(rz, rx, words * sizeof(*rx)) == 0)
+					break;
+				*y = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(both);
+				return z;
 			}
 		}
+		return -1;
 	}
 
-	return true;
-}
+	c->hashes[x] = rf_bitrow_hash(rx, words);
+	const size_t first = rf_bitrow_first(rx, words);
+	if(first == RF_BITROW_NONE)
+		return -1;
 
-bool
-rf_relation_is_equivalent(const rf_Relation *r) {
-	assert(r != NULL);
+	*y = first;
+	const int z = c->owner[first];
+	if(z >= 0) {
+		if(c->hashes[z] == c->hashes[x] && memcmp(rf_relation_row_const(r, z), rx, words * sizeof(*rx)) == 0)
+			return -1;
+		return z;
+	}
 
-	return rf_relation_is_reflexive(r) && rf_relation_is_symmetric(r) && rf_relation_is_transitive(r);
+	for(size_t w = 0; w < words; w++) {
+		for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1) {
+			*y = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+			if(c->owner[*y] >= 0)
+				return c->owner[*y];
+			c->owner[*y] = x;
+		}
+	}
+
+	return -1;
 }
 
-bool
-rf_relation_is_irreflexive(const rf_Relation *r) {
-	assert(r != NULL);
+/*
+ * Decides the properties in wanted in a single pass over the rows and their transpose
+ * and returns those of them that hold. *decided receives the properties that were
+ * looked at, wanted plus what these depend on; other bits of the result are 0. A
+ * property is dropped on its first counterexample, the pass ends once nothing
+ * wanted is left.
+ */
+static unsigned int
+rf_relation_scan_properties(const rf_Relation *r, unsigned int wanted, unsigned int *decided) {
+	unsigned int alive = wanted;
+	if(wanted & (RF_PROPERTY_EQUIVALENT | RF_PROPERTY_PREORDER | RF_PROPERTY_PARTIAL_ORDER))
+		alive |= RF_PROPERTY_REFLEXIVE | RF_PROPERTY_TRANSITIVE;
+	if(wanted & RF_PROPERTY_ASYMMETRIC)
+		alive |= RF_PROPERTY_REFLEXIVE;
+	if(wanted & (RF_PROPERTY_EQUIVALENT))
+		alive |= RF_PROPERTY_SYMMETRIC;
+	if(wanted & (RF_PROPERTY_PARTIAL_ORDER | RF_PROPERTY_ASYMMETRIC))
+		alive |= RF_PROPERTY_ANTISYMMETRIC;
+	if(wanted & RF_PROPERTY_FUNCTION)
+		alive |= RF_PROPERTY_LEFTTOTAL | RF_PROPERTY_FUNCTIONAL;
+	if(wanted & RF_PROPERTY_BIJECTIVE)
+		alive |= RF_PROPERTY_INJECTIVE | RF_PROPERTY_SURJECTIVE;
+
+	if(alive & HOMOGENEOUS_PROPERTIES)
+		alive |= RF_PROPERTY_HOMOGENEOUS;
+	*decided = alive;
+
+	if(alive & RF_PROPERTY_HOMOGENEOUS) {
+		bool homogeneous = (r->known & RF_PROPERTY_HOMOGENEOUS) ? (r->properties & RF_PROPERTY_HOMOGENEOUS) != 0
+		                   : rf_set_equal(r->domains[0], r->domains[1]);
+		if(!homogeneous)
+			alive &= ~(HOMOGENEOUS_PROPERTIES | RF_PROPERTY_HOMOGENEOUS);
+	}
+
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	const size_t words = (dim2 + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+
+	uint64_t *seen = NULL, *twice = NULL;
+	if(alive & SEEN_PROPERTIES) {
+		seen = rf_bitrow_alloc(r->stride);
+		twice = rf_bitrow_alloc(r->stride);
+	}
+	// without memory for the columns seen they are counted one by one after the rows
+	const bool counting = (alive & SEEN_PROPERTIES) && (seen == NULL || twice == NULL);
+	const unsigned int row_properties = counting ? ROW_PROPERTIES & ~SEEN_PROPERTIES : ROW_PROPERTIES;
+
+	// without memory for the transpose the columns are gathered bit by bit
+	uint64_t *t = NULL;
+	size_t t_stride = rf_bitrow_words(dim1);
+	if((alive & COLUMN_PROPERTIES) || counting)
+		t = rf_relation_transpose_table(r);
+
+	rf_RowClasses classes;
+	const bool grouping = alive & RF_PROPERTY_DIFUNCTIONAL;
+	if(grouping)
+		rf_row_classes_init(&classes, r);
+
+	for(int x = 0; x < dim1 && (alive & row_properties); x++) {
+		const uint64_t *rx = rf_relation_row_const(r, x);
+
+		if(alive & (RF_PROPERTY_LEFTTOTAL | RF_PROPERTY_FUNCTIONAL)) {
+			size_t count = 0;
+			for(size_t w = 0; w < words && count < 2; w++)
+				count += rf_bitrow_popcount(rx[w]);
+			if(count == 0)
+				alive &= ~RF_PROPERTY_LEFTTOTAL;
+			if(count > 1)
+				alive &= ~RF_PROPERTY_FUNCTIONAL;
+		}
 
-	if(!rf_relation_is_homogeneous(r))
-		return false;
+		if((alive & SEEN_PROPERTIES) && !counting) {
+			rf_bitrow_accumulate(seen, twice, rx, words);
+			if((alive & RF_PROPERTY_INJECTIVE) && rf_bitrow_first(twice, words) != RF_BITROW_NONE)
+				alive &= ~RF_PROPERTY_INJECTIVE;
+		}
 
-	const int dim = r->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		if(r->table[rf_table_idx(r, x, x)])
-			return false;
-	}
+		if(!(alive & HOMOGENEOUS_PROPERTIES))
+			continue;
 
-	return true;
-}
+		alive &= rf_bitrow_get(rx, x) ? ~RF_PROPERTY_IRREFLEXIVE : ~RF_PROPERTY_REFLEXIVE;
+
+		// xRy against yRx for all y at once
+		if(alive & (RF_PROPERTY_SYMMETRIC | RF_PROPERTY_ANTISYMMETRIC)) {
+			for(size_t w = 0; w < words; w++) {
+				const uint64_t column = column_word(r, t, t_stride, x, w);
+				uint64_t both = rx[w] & column;
+				if(w == (size_t) x / RF_BITROW_WORD_BITS)
+					both &= ~(UINT64_C(1) << (x % RF_BITROW_WORD_BITS));
+				if(rx[w] != column)
+					alive &= ~RF_PROPERTY_SYMMETRIC;
+				if(both != 0)
+					alive &= ~RF_PROPERTY_ANTISYMMETRIC;
+			}
+		}
 
-bool
-rf_relation_is_partial_order(const rf_Relation *r) {
-	assert(r != NULL);
+		// xRy => row y is a subset of row x
+		for(size_t w = 0; w < words && (alive & RF_PROPERTY_TRANSITIVE); w++) {
+			for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1) {
+				const int y = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+				if(rf_bitrow_first_andnot(rf_relation_row_const(r, y), rx, words) != RF_BITROW_NONE) {
+					alive &= ~RF_PROPERTY_TRANSITIVE;
+					break;
+				}
+			}
+		}
 
-	return rf_relation_is_reflexive(r) && rf_relation_is_antisymmetric(r) && rf_relation_is_transitive(r);
+		int y;
+		if((alive & RF_PROPERTY_DIFUNCTIONAL) && rf_row_classes_add(&classes, r, x, &y) >= 0)
+			alive &= ~RF_PROPERTY_DIFUNCTIONAL;
+	}
+
+	if(counting) {
+		const size_t t_words = (dim1 + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+		for(int y = 0; y < dim2 && (alive & SEEN_PROPERTIES); y++) {
+			size_t count = 0;
+			for(size_t w = 0; w < t_words && count < 2; w++)
+				count += rf_bitrow_popcount(column_word(r, t, t_stride, y, w));
+			if(count == 0)
+				alive &= ~RF_PROPERTY_SURJECTIVE;
+			if(count > 1)
+				alive &= ~RF_PROPERTY_INJECTIVE;
+		}
+	} else if((alive & RF_PROPERTY_SURJECTIVE) && rf_bitrow_count(seen, words) != (size_t) dim2)
+		alive &= ~RF_PROPERTY_SURJECTIVE;
+
+	rf_bitrow_free(twice);
+	rf_bitrow_free(seen);
+	rf_bitrow_free(t);
+	if(grouping)
+		rf_row_classes_destroy(&classes);
+
+	const bool reflexive = alive & RF_PROPERTY_REFLEXIVE;
+	const bool antisymmetric = alive & RF_PROPERTY_ANTISYMMETRIC;
+	const bool transitive = alive & RF_PROPERTY_TRANSITIVE;
+	if(!(reflexive && transitive))
+		alive &= ~(RF_PROPERTY_EQUIVALENT | RF_PROPERTY_PREORDER | RF_PROPERTY_PARTIAL_ORDER);
+	if(!(alive & RF_PROPERTY_SYMMETRIC))
+		alive &= ~RF_PROPERTY_EQUIVALENT;
+	if(!antisymmetric)
+		alive &= ~RF_PROPERTY_PARTIAL_ORDER;
+	// as rf_relation_is_asymmetric has it: not reflexive but antisymmetric
+	if(reflexive || !antisymmetric)
+		alive &= ~RF_PROPERTY_ASYMMETRIC;
+	if(!(alive & RF_PROPERTY_LEFTTOTAL) || !(alive & RF_PROPERTY_FUNCTIONAL))
+		alive &= ~RF_PROPERTY_FUNCTION;
+	if(!(alive & RF_PROPERTY_INJECTIVE) || !(alive & RF_PROPERTY_SURJECTIVE))
+		alive &= ~RF_PROPERTY_BIJECTIVE;
+
+	return alive & *decided;
 }
 
-bool
-rf_relation_is_preorder(const rf_Relation *r) {
-	assert(r != NULL);
+/*
+ * Properties a fresh tracker answers without a scan.
+ */
+#define TRACKED_PROPERTIES      (RF_PROPERTY_REFLEXIVE | RF_PROPERTY_IRREFLEXIVE | RF_PROPERTY_SYMMETRIC \
+                                 | RF_PROPERTY_ANTISYMMETRIC | RF_PROPERTY_ASYMMETRIC | RF_PROPERTY_LEFTTOTAL \
+                                 | RF_PROPERTY_FUNCTIONAL | RF_PROPERTY_FUNCTION | RF_PROPERTY_SURJECTIVE \
+                                 | RF_PROPERTY_INJECTIVE | RF_PROPERTY_BIJECTIVE)
 
-	return rf_relation_is_reflexive(r) && rf_relation_is_transitive(r);
+/*
+ * Moves the counts of rows (or columns) without and with more than one pair along
+ * when one of them goes from before to after pairs.
+ */
+static void
+rf_tracker_count_degree(size_t *empty, size_t *multi, int before, int after) {
+	if(before == 0)
+		--*empty;
+	if(before > 1)
+		--*multi;
+	if(after == 0)
+		++*empty;
+	if(after > 1)
+		++*multi;
 }
 
-// xRx
-bool
-rf_relation_is_reflexive(const rf_Relation *r) {
-	assert(r != NULL);
-
-	if(!rf_relation_is_homogeneous(r))
-		return false;
+/*
+ * Counts everything from scratch, O(n^2 / 64) plus one probe of the mirror cell per
+ * pair.
+ */
+static void
+rf_tracker_rebuild(rf_Relation *r) {
+	rf_RelationTracker *t = r->tracker;
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	const size_t words = (dim2 + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+
+	t->homogeneous = rf_relation_is_homogeneous(r);
+	t->diagonal = 0;
+	t->asymmetric = 0;
+	t->symmetric = 0;
+	memset(t->degrees, 0, (dim1 + dim2) * sizeof(*t->degrees));
+
+	for(int x = 0; x < dim1; x++) {
+		const uint64_t *rx = rf_relation_row_const(r, x);
+		for(size_t w = 0; w < words; w++) {
+			for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1) {
+				const int y = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+				t->degrees[x]++;
+				t->degrees[dim1 + y]++;
+				if(!t->homogeneous)
+					continue;
+				if(x == y)
+					t->diagonal++;
+				else if(rf_relation_get(r, y, x))
+					t->symmetric++;
+				else
+					t->asymmetric++;
+			}
+		}
+	}
+	t->symmetric /= 2;
 
-	const int dim = r->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		if(!r->table[rf_table_idx(r, x, x)])
-			return false;
-		// xRx exists
-		assert(r->table[rf_table_idx(r, x, x)]);
+	t->empty_rows = t->multi_rows = t->empty_columns = t->multi_columns = 0;
+	for(int i = 0; i < dim1 + dim2; i++) {
+		size_t *empty = i < dim1 ? &t->empty_rows : &t->empty_columns;
+		size_t *multi = i < dim1 ? &t->multi_rows : &t->multi_columns;
+		if(t->degrees[i] == 0)
+			++*empty;
+		if(t->degrees[i] > 1)
+			++*multi;
 	}
 
-	return true;
+	t->stale = false;
 }
 
-bool
-rf_relation_is_symmetric(const rf_Relation *r) {
-	assert(r != NULL);
+/*
+ * The tracked properties as the counters have them.
+ */
+static unsigned int
+rf_tracker_properties(rf_Relation *r) {
+	rf_RelationTracker *t = r->tracker;
+	unsigned int p = 0;
+
+	if(t->stale)
+		rf_tracker_rebuild(r);
+
+	if(t->homogeneous) {
+		const bool reflexive = t->diagonal == (size_t) r->domains[0]->cardinality;
+		if(reflexive)
+			p |= RF_PROPERTY_REFLEXIVE;
+		if(t->diagonal == 0)
+			p |= RF_PROPERTY_IRREFLEXIVE;
+		if(t->asymmetric == 0)
+			p |= RF_PROPERTY_SYMMETRIC;
+		if(t->symmetric == 0)
+			p |= RF_PROPERTY_ANTISYMMETRIC;
+		if(!reflexive && t->symmetric == 0)
+			p |= RF_PROPERTY_ASYMMETRIC;
+	}
+	if(t->empty_rows == 0)
+		p |= RF_PROPERTY_LEFTTOTAL;
+	if(t->multi_rows == 0)
+		p |= RF_PROPERTY_FUNCTIONAL;
+	if(t->empty_rows == 0 && t->multi_rows == 0)
+		p |= RF_PROPERTY_FUNCTION;
+	if(t->empty_columns == 0)
+		p |= RF_PROPERTY_SURJECTIVE;
+	if(t->multi_columns == 0)
+		p |= RF_PROPERTY_INJECTIVE;
+	if(t->empty_columns == 0 && t->multi_columns == 0)
+		p |= RF_PROPERTY_BIJECTIVE;
+
+	return p;
+}
 
-	if(!rf_relation_is_homogeneous(r))
-		return false;
+/*
+ * Updates the counters for cell (x, y) about to become value. Called by
+ * rf_relation_set before the write.
+ */
+void
+rf_relation_track_cell(rf_Relation *r, int x, int y, bool value) {
+	rf_RelationTracker *t = r->tracker;
+	const int dim1 = r->domains[0]->cardinality;
+
+	if(rf_relation_get(r, x, y) == value)
+		return;
+
+	const int d = value ? 1 : -1;
+	t->degrees[x] += d;
+	rf_tracker_count_degree(&t->empty_rows, &t->multi_rows, t->degrees[x] - d, t->degrees[x]);
+	t->degrees[dim1 + y] += d;
+	rf_tracker_count_degree(&t->empty_columns, &t->multi_columns, t->degrees[dim1 + y] - d, t->degrees[dim1 + y]);
+
+	if(!t->homogeneous)
+		return;
+
+	if(x == y) {
+		t->diagonal += d;
+	} else if(rf_relation_get(r, y, x)) {
+		// yRx stops or starts being alone
+		t->symmetric += d;
+		t->asymmetric -= d;
+	} else {
+		t->asymmetric += d;
+	}
+}
 
-	const int dim = r->domains[0]->cardinality;
+/*
+ * Switches on the counters of r, see rf_RelationTracker. Tracking an already tracked
+ * relation does nothing.
+ */
+bool
+rf_relation_track(rf_Relation *r, rf_Error *error) {
+	assert(r != NULL);
 
-	for(int x = 0; x < dim; x++) {
-		for(int y = x; y < dim; y++) { //don't need to check mirror elements twice
-			if(x == y) //don't need to check elements related to themself
-				continue;
-			if(r->table[rf_table_idx(r,x,y)] && !r->table[rf_table_idx(r,y,x)])
-				return false;
-		}
+	if(r->tracker != NULL)
+		return true;
+
+	const int dims = r->domains[0]->cardinality + r->domains[1]->cardinality;
+	rf_RelationTracker *t = malloc(sizeof(*t));
+	int *degrees = malloc((dims > 0 ? dims : 1) * sizeof(*degrees));
+	if(t == NULL || degrees == NULL) {
+		free(t);
+		free(degrees);
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return false;
 	}
 
+	t->degrees = degrees;
+	r->tracker = t;
+	rf_tracker_rebuild(r);
+
 	return true;
 }
 
+void
+rf_relation_untrack(rf_Relation *r) {
+	assert(r != NULL);
+
+	if(r->tracker == NULL)
+		return;
+
+	free(r->tracker->degrees);
+	free(r->tracker);
+	r->tracker = NULL;
+}
+
+/*
+ * The properties in wanted that hold, answered from the counters of a tracked r and
+ * the cache of r as far as possible. Only the missing ones are scanned for, the
+ * result is added to the cache. Cache and counters do not count as part of the
+ * value, so they are written even through a const r.
+ */
+static unsigned int
+rf_relation_test_properties(const rf_Relation *r, unsigned int wanted) {
+	rf_Relation *cache = (rf_Relation *) r;
+	unsigned int missing = wanted & ~r->known;
+
+	if((missing & TRACKED_PROPERTIES) && r->tracker != NULL) {
+		// recounting may look up homogeneity and cache it, so read properties after
+		unsigned int tracked = rf_tracker_properties(cache);
+		cache->properties = (r->properties & ~TRACKED_PROPERTIES) | tracked;
+		cache->known |= TRACKED_PROPERTIES;
+		missing = wanted & ~r->known;
+	}
+
+	if(missing != 0) {
+		unsigned int decided;
+		unsigned int found = rf_relation_scan_properties(r, missing, &decided);
+		cache->properties = (r->properties & ~decided) | found;
+		cache->known |= decided;
+	}
+
+	return r->properties & wanted;
+}
+
+/*
+ * All properties of r as a mask of rf_RelationProperty, computed in one pass.
+ */
+unsigned int
+rf_relation_properties(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_ALL);
+}
+
+bool
+rf_relation_is_homogeneous(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_HOMOGENEOUS) != 0;
+}
+
+// xRy => !yRx
+bool
+rf_relation_is_antisymmetric(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_ANTISYMMETRIC) != 0;
+}
+
+bool
+rf_relation_is_asymmetric(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_ASYMMETRIC) != 0;
+}
+
+// xRy & zRy & zRw => xRw
+bool
+rf_relation_is_difunctional(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_DIFUNCTIONAL) != 0;
+}
+
+bool
+rf_relation_is_equivalent(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_EQUIVALENT) != 0;
+}
+
+bool
+rf_relation_is_irreflexive(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_IRREFLEXIVE) != 0;
+}
+
+bool
+rf_relation_is_partial_order(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_PARTIAL_ORDER) != 0;
+}
+
+bool
+rf_relation_is_preorder(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_PREORDER) != 0;
+}
+
+// xRx
+bool
+rf_relation_is_reflexive(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_REFLEXIVE) != 0;
+}
+
+// xRy => yRx
+bool
+rf_relation_is_symmetric(const rf_Relation *r) {
+	assert(r != NULL);
+
+	return rf_relation_test_properties(r, RF_PROPERTY_SYMMETRIC) != 0;
+}
+
 // xRy & yRz => xRz
 bool
 rf_relation_is_transitive(const rf_Relation *r) {
 	assert(r != NULL);
 
-	if(!rf_relation_is_homogeneous(r))
+	return rf_relation_test_properties(r, RF_PROPERTY_TRANSITIVE) != 0;
+}
+
+/*
+ * Stores a counterexample to property made of n indices into witness, if given. Bit i
+ * of second tells that index i is taken from domains[1] rather than domains[0].
+ * Returns false, the answer of the predicate that found it.
+ */
+static bool
+rf_relation_refute(const rf_Relation *r, rf_RelationWitness *witness, rf_RelationProperty property,
+                   unsigned int second, int n, ...) {
+	if(witness == NULL)
 		return false;
 
-	const int dim = r->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		for(int y = dim-1; y >= 0; --y) {
-			if(x == y)
-				continue;
-			if(!r->table[rf_table_idx(r, x, y)])
-				continue;
-			// xRy exists
-			assert(r->table[rf_table_idx(r, x, y)]);
-			for(int z = dim-1; z >= 0; --z) {
-				if(!r->table[rf_table_idx(r, y, z)])
-					continue;
-				// yRz exists
-				assert(r->table[rf_table_idx(r, y, z)]);
-				if(!r->table[rf_table_idx(r, x, z)])
-					return false;
-				// xRz exists
-				assert(r->table[rf_table_idx(r, x, z)]);
+	va_list indices;
+	va_start(indices, n);
+	witness->property = property;
+	witness->n = n;
+	for(int i = 0; i < n; i++) {
+		witness->index[i] = va_arg(indices, int);
+		witness->elements[i] = r->domains[(second >> i) & 1]->elements[witness->index[i]];
+	}
+	va_end(indices);
+
+	return false;
+}
+
+/*
+ * Whether row has at least two bits set, the first two of them go to pair.
+ */
+static bool
+rf_bitrow_first_pair(const uint64_t *row, size_t nwords, int pair[2]) {
+	int found = 0;
+	for(size_t w = 0; w < nwords; w++) {
+		for(uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+			pair[found++] = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+			if(found == 2)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Searches the columns one by one for a counterexample to surjective or injective,
+ * the same one the scan over the rows finds. t is the transpose of the table or NULL.
+ */
+static bool
+rf_relation_scan_columns(const rf_Relation *r, const uint64_t *t, rf_RelationProperty property,
+                         rf_RelationWitness *witness) {
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	const size_t t_words = (dim1 + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+	const size_t t_stride = rf_bitrow_words(dim1);
+
+	// the row scan meets column y again in the row of its second bit
+	int x = dim1, y = -1, z = -1;
+	for(int c = 0; c < dim2; c++) {
+		int pair[2];
+		int found = 0;
+		for(size_t w = 0; w < t_words && found < 2; w++) {
+			for(uint64_t bits = column_word(r, t, t_stride, c, w); bits != 0 && found < 2; bits &= bits - 1)
+				pair[found++] = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+		}
+		if(property == RF_PROPERTY_SURJECTIVE && found == 0)
+			return rf_relation_refute(r, witness, property, 1, 1, c);
+		if(property == RF_PROPERTY_INJECTIVE && found == 2 && pair[1] < x) {
+			x = pair[1];
+			y = c;
+			z = pair[0];
+		}
+	}
+	if(y >= 0)
+		return rf_relation_refute(r, witness, property, 4, 3, z, x, y);
+
+	return true;
+}
+
+/*
+ * Searches the table for a counterexample to one of the properties reflexive,
+ * irreflexive, symmetric, antisymmetric, transitive, difunctional, lefttotal,
+ * functional, surjective or injective, stopping at the first one. t is the
+ * transpose of the table or NULL.
+ */
+static bool
+rf_relation_scan_witness(const rf_Relation *r, const uint64_t *t, rf_RelationProperty property,
+                         rf_RelationWitness *witness) {
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	const size_t words = (dim2 + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+	const size_t t_stride = rf_bitrow_words(dim1);
+
+	rf_RowClasses classes;
+	if(property == RF_PROPERTY_DIFUNCTIONAL)
+		rf_row_classes_init(&classes, r);
+
+	// the columns related to some row before x
+	uint64_t *seen = NULL;
+	if(property & SEEN_PROPERTIES) {
+		seen = rf_bitrow_alloc(r->stride);
+		if(seen == NULL)
+			return rf_relation_scan_columns(r, t, property, witness);
+	}
+
+	for(int x = 0; x < dim1 && (property & ROW_PROPERTIES); x++) {
+		const uint64_t *rx = rf_relation_row_const(r, x);
+
+		switch(property) {
+		case RF_PROPERTY_REFLEXIVE:
+			if(!rf_bitrow_get(rx, x))
+				return rf_relation_refute(r, witness, property, 0, 1, x);
+			break;
+		case RF_PROPERTY_IRREFLEXIVE:
+			if(rf_bitrow_get(rx, x))
+				return rf_relation_refute(r, witness, property, 0, 1, x);
+			break;
+		case RF_PROPERTY_SYMMETRIC:
+			for(size_t w = 0; w < words; w++) {
+				uint64_t alone = rx[w] & ~column_word(r, t, t_stride, x, w);
+				if(alone != 0)
+					return rf_relation_refute(r, witness, property, 0, 2, x,
+					                          (int) (w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(alone)));
+			}
+			break;
+		case RF_PROPERTY_ANTISYMMETRIC:
+			for(size_t w = 0; w < words; w++) {
+				uint64_t both = rx[w] & column_word(r, t, t_stride, x, w);
+				if(w == (size_t) x / RF_BITROW_WORD_BITS)
+					both &= ~(UINT64_C(1) << (x % RF_BITROW_WORD_BITS));
+				if(both != 0)
+					return rf_relation_refute(r, witness, property, 0, 2, x,
+					                          (int) (w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(both)));
 			}
+			break;
+		case RF_PROPERTY_TRANSITIVE:
+			// xRy => row y is a subset of row x
+			for(size_t w = 0; w < words; w++) {
+				for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1) {
+					const int y = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+					size_t z = rf_bitrow_first_andnot(rf_relation_row_const(r, y), rx, words);
+					if(z != RF_BITROW_NONE)
+						return rf_relation_refute(r, witness, property, 0, 3, x, y, (int) z);
+				}
+			}
+			break;
+		case RF_PROPERTY_DIFUNCTIONAL: {
+			int y;
+			const int z = rf_row_classes_add(&classes, r, x, &y);
+			if(z < 0)
+				break;
+			// rows x and z share y but differ in v
+			const uint64_t *rz = rf_relation_row_const(r, z);
+			rf_row_classes_destroy(&classes);
+			size_t v = rf_bitrow_first_andnot(rz, rx, words);
+			if(v != RF_BITROW_NONE)
+				return rf_relation_refute(r, witness, property, 0, 4, x, y, z, (int) v);
+			v = rf_bitrow_first_andnot(rx, rz, words);
+			return rf_relation_refute(r, witness, property, 0, 4, z, y, x, (int) v);
+		}
+		case RF_PROPERTY_LEFTTOTAL:
+			if(rf_bitrow_count(rx, words) == 0)
+				return rf_relation_refute(r, witness, property, 0, 1, x);
+			break;
+		case RF_PROPERTY_FUNCTIONAL: {
+			int pair[2];
+			if(rf_bitrow_first_pair(rx, words, pair))
+				return rf_relation_refute(r, witness, property, 6, 3, x, pair[0], pair[1]);
+			break;
+		}
+		case RF_PROPERTY_SURJECTIVE:
+		case RF_PROPERTY_INJECTIVE:
+			for(size_t w = 0; w < words; w++) {
+				const uint64_t again = rx[w] & seen[w];
+				if(property == RF_PROPERTY_INJECTIVE && again != 0) {
+					// z is the row the column was seen in first
+					const int y = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(again);
+					int z = 0;
+					while(!rf_relation_get(r, z, y))
+						z++;
+					rf_bitrow_free(seen);
+					return rf_relation_refute(r, witness, property, 4, 3, z, x, y);
+				}
+				seen[w] |= rx[w];
+			}
+			break;
+		default:
+			break;
 		}
 	}
 
+	if(property == RF_PROPERTY_DIFUNCTIONAL)
+		rf_row_classes_destroy(&classes);
+
+	for(int y = 0; y < dim2 && property == RF_PROPERTY_SURJECTIVE; y++) {
+		if(!rf_bitrow_get(seen, y)) {
+			rf_bitrow_free(seen);
+			return rf_relation_refute(r, witness, property, 1, 1, y);
+		}
+	}
+	rf_bitrow_free(seen);
+
 	return true;
 }
+/*
+ * Properties made of others, checked part by part by rf_relation_find_witness.
+ */
+static unsigned int
+rf_property_parts(rf_RelationProperty property) {
+	switch(property) {
+	case RF_PROPERTY_EQUIVALENT:
+		return RF_PROPERTY_REFLEXIVE | RF_PROPERTY_SYMMETRIC | RF_PROPERTY_TRANSITIVE;
+	case RF_PROPERTY_PREORDER:
+		return RF_PROPERTY_REFLEXIVE | RF_PROPERTY_TRANSITIVE;
+	case RF_PROPERTY_PARTIAL_ORDER:
+		return RF_PROPERTY_REFLEXIVE | RF_PROPERTY_ANTISYMMETRIC | RF_PROPERTY_TRANSITIVE;
+	case RF_PROPERTY_FUNCTION:
+		return RF_PROPERTY_LEFTTOTAL | RF_PROPERTY_FUNCTIONAL;
+	case RF_PROPERTY_BIJECTIVE:
+		return RF_PROPERTY_SURJECTIVE | RF_PROPERTY_INJECTIVE;
+	default:
+		return 0;
+	}
+}
 
-rf_Set *
-rf_relation_find_minimal_elements(const rf_Relation *r, rf_Set *s, rf_Error *error) {
+/*
+ * Decides property as rf_relation_test_properties does and, if it does not hold and
+ * witness is given, finds a counterexample on the way. Properties known to hold are
+ * answered from the cache; the outcome of a search goes into it.
+ */
+static bool
+rf_relation_find_witness(const rf_Relation *r, rf_RelationProperty property, rf_RelationWitness *witness) {
+	if(witness != NULL) {
+		witness->property = property;
+		witness->n = 0;
+	}
+
+	if(witness == NULL || ((r->known & property) && (r->properties & property))
+	   || (r->tracker != NULL && (property & TRACKED_PROPERTIES))) {
+		if(rf_relation_test_properties(r, property) != 0)
+			return true;
+		if(witness == NULL)
+			return false;
+	}
+
+	if((property & (HOMOGENEOUS_PROPERTIES | RF_PROPERTY_EQUIVALENT | RF_PROPERTY_PREORDER
+	                | RF_PROPERTY_PARTIAL_ORDER | RF_PROPERTY_ASYMMETRIC)) && !rf_relation_is_homogeneous(r))
+		return rf_relation_refute(r, witness, RF_PROPERTY_HOMOGENEOUS, 0, 0);
+
+	bool holds = true;
+	if(property == RF_PROPERTY_ASYMMETRIC) {
+		// as rf_relation_is_asymmetric has it: not reflexive but antisymmetric
+		if(rf_relation_find_witness(r, RF_PROPERTY_REFLEXIVE, NULL))
+			holds = rf_relation_refute(r, witness, property, 0, 0);
+		else
+			holds = rf_relation_find_witness(r, RF_PROPERTY_ANTISYMMETRIC, witness);
+	} else if(rf_property_parts(property) != 0) {
+		for(unsigned int parts = rf_property_parts(property); parts != 0 && holds; parts &= parts - 1)
+			holds = rf_relation_find_witness(r, parts & -parts, witness);
+	} else {
+		uint64_t *t = (property & COLUMN_PROPERTIES) ? rf_relation_transpose_table(r) : NULL;
+		holds = rf_relation_scan_witness(r, t, property, witness);
+		rf_bitrow_free(t);
+	}
+
+	rf_Relation *cache = (rf_Relation *) r;
+	cache->known |= property;
+	if(holds)
+		cache->properties |= property;
+	else
+		cache->properties &= ~property;
+
+	return holds;
+}
+
+/*
+ * The rf_relation_is_*_witness functions answer like their predicates. If the
+ * property does not hold and witness is given, it receives the first counterexample
+ * found, see rf_RelationWitness.
+ */
+bool
+rf_relation_is_antisymmetric_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_ANTISYMMETRIC, witness);
+}
+
+bool
+rf_relation_is_asymmetric_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_ASYMMETRIC, witness);
+}
+
+bool
+rf_relation_is_difunctional_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_DIFUNCTIONAL, witness);
+}
+
+bool
+rf_relation_is_equivalent_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_EQUIVALENT, witness);
+}
+
+bool
+rf_relation_is_irreflexive_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_IRREFLEXIVE, witness);
+}
+
+bool
+rf_relation_is_partial_order_witness(const rf_Relation *r, rf_RelationWitness *witness) {
 	assert(r != NULL);
 
-	rf_SetElement **mins = malloc(sizeof(mins)*s->cardinality);
-	rf_Set *returnSet = rf_set_new(0, mins);
+	return rf_relation_find_witness(r, RF_PROPERTY_PARTIAL_ORDER, witness);
+}
+
+bool
+rf_relation_is_preorder_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_PREORDER, witness);
+}
+
+bool
+rf_relation_is_reflexive_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_REFLEXIVE, witness);
+}
+
+bool
+rf_relation_is_symmetric_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_SYMMETRIC, witness);
+}
+
+/*
+ * R is transitive iff row y is a subset of row x for every xRy.
+ */
+bool
+rf_relation_is_transitive_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_TRANSITIVE, witness);
+}
+
+bool
+rf_relation_is_lefttotal_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_LEFTTOTAL, witness);
+}
+
+bool
+rf_relation_is_functional_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_FUNCTIONAL, witness);
+}
+
+bool
+rf_relation_is_function_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_FUNCTION, witness);
+}
+
+bool
+rf_relation_is_surjective_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_SURJECTIVE, witness);
+}
+
+bool
+rf_relation_is_injective_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_INJECTIVE, witness);
+}
+
+bool
+rf_relation_is_bijective_witness(const rf_Relation *r, rf_RelationWitness *witness) {
+	assert(r != NULL);
+
+	return rf_relation_find_witness(r, RF_PROPERTY_BIJECTIVE, witness);
+}
+
+/*
+ * Number of pairs c ANDNOT r over n rows, the pairs of c missing from r.
+ */
+static size_t
+rf_table_count_andnot(const uint64_t *c, const uint64_t *r, size_t stride, size_t n) {
+	size_t count = 0;
+	for(size_t i = 0; i < n * stride; i++)
+		count += rf_bitrow_popcount(c[i] & ~r[i]);
+
+	return count;
+}
+
+/*
+ * How often r violates property, counted with popcounts over whole words:
+ *
+ *  reflexive, irreflexive   elements x without (with) xRx
+ *  symmetric                pairs xRy without yRx
+ *  antisymmetric            unordered pairs x != y with xRy and yRx
+ *  transitive               pairs of R;R missing from R
+ *  difunctional             pairs of R;R^-1;R missing from R
+ *  lefttotal, functional    rows without a pair, with more than one
+ *  surjective, injective    columns without a pair, with more than one
+ *
+ * Composite properties have no count. Returns 0 with an error set if the property
+ * needs a homogeneous relation and r is none, or if memory runs out.
+ */
+size_t
+rf_relation_count_violations(const rf_Relation *r, rf_RelationProperty property, rf_Error *error) {
+	assert(r != NULL);
+	assert((property & (ROW_PROPERTIES | COLUMN_PROPERTIES)) && !(property & (property - 1)));
+
+	if((property & HOMOGENEOUS_PROPERTIES) && !rf_relation_is_homogeneous(r)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return 0;
+	}
+
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	const size_t words = (dim2 + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+	const size_t t_stride = rf_bitrow_words(dim1);
+	uint64_t *t = (property & (COLUMN_PROPERTIES | RF_PROPERTY_DIFUNCTIONAL)) ? rf_relation_transpose_table(r) : NULL;
+	uint64_t *p = NULL, *q = NULL;
+	bool out_of_memory = false;
+	size_t count = 0;
+
+	switch(property) {
+	case RF_PROPERTY_REFLEXIVE:
+	case RF_PROPERTY_IRREFLEXIVE:
+		for(int x = 0; x < dim1; x++)
+			count += rf_relation_get(r, x, x);
+		if(property == RF_PROPERTY_REFLEXIVE)
+			count = dim1 - count;
+		break;
+	case RF_PROPERTY_SYMMETRIC:
+	case RF_PROPERTY_ANTISYMMETRIC:
+		for(int x = 0; x < dim1; x++) {
+			const uint64_t *rx = rf_relation_row_const(r, x);
+			for(size_t w = 0; w < words; w++) {
+				const uint64_t column = column_word(r, t, t_stride, x, w);
+				count += rf_bitrow_popcount(property == RF_PROPERTY_SYMMETRIC ? rx[w] & ~column : rx[w] & column);
+			}
+			if(property == RF_PROPERTY_ANTISYMMETRIC)
+				count -= rf_bitrow_get(rx, x);
+		}
+		if(property == RF_PROPERTY_ANTISYMMETRIC)
+			count /= 2;
+		break;
+	case RF_PROPERTY_TRANSITIVE:
+		p = rf_bitrow_alloc(rf_table_words(r));
+		if(p != NULL && rf_bitmatrix_product(p, r->stride, r->table, r->stride, r->table, r->stride, dim1, dim1, dim1))
+			count = rf_table_count_andnot(p, r->table, r->stride, dim1);
+		else
+			out_of_memory = true;
+		break;
+	case RF_PROPERTY_DIFUNCTIONAL:
+		// R;R^-1 relates the rows sharing a column
+		p = rf_bitrow_alloc((size_t) dim1 * t_stride);
+		q = rf_bitrow_alloc(rf_table_words(r));
+		if(t != NULL && p != NULL && q != NULL
+		   && rf_bitmatrix_product(p, t_stride, r->table, r->stride, t, t_stride, dim1, dim2, dim1)
+		   && rf_bitmatrix_product(q, r->stride, p, t_stride, r->table, r->stride, dim1, dim1, dim2))
+			count = rf_table_count_andnot(q, r->table, r->stride, dim1);
+		else
+			out_of_memory = true;
+		break;
+	case RF_PROPERTY_LEFTTOTAL:
+	case RF_PROPERTY_FUNCTIONAL:
+		for(int x = 0; x < dim1; x++) {
+			size_t degree = rf_bitrow_count(rf_relation_row_const(r, x), words);
+			count += property == RF_PROPERTY_LEFTTOTAL ? degree == 0 : degree > 1;
+		}
+		break;
+	case RF_PROPERTY_SURJECTIVE:
+	case RF_PROPERTY_INJECTIVE:
+		p = rf_bitrow_alloc(r->stride);
+		q = rf_bitrow_alloc(r->stride);
+		if(p == NULL || q == NULL) {
+			out_of_memory = true;
+			break;
+		}
+		for(int x = 0; x < dim1; x++)
+			rf_bitrow_accumulate(p, q, rf_relation_row_const(r, x), words);
+		count = property == RF_PROPERTY_SURJECTIVE ? dim2 - rf_bitrow_count(p, words) : rf_bitrow_count(q, words);
+		break;
+	default:
+		break;
+	}
+
+	rf_bitrow_free(q);
+	rf_bitrow_free(p);
+	rf_bitrow_free(t);
+
+	if(out_of_memory) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return 0;
+	}
+
+	return count;
+}
+
+/*
+ * Whether row and set have a bit in common other than skip, which may be
+ * RF_BITROW_NONE.
+ */
+static bool
+rf_bitrow_meets(const uint64_t *row, const uint64_t *set, size_t nwords, size_t skip) {
+	for(size_t w = 0; w < nwords; w++) {
+		uint64_t common = row[w] & set[w];
+		if(w == skip / RF_BITROW_WORD_BITS)
+			common &= ~(UINT64_C(1) << (skip % RF_BITROW_WORD_BITS));
+		if(common != 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * The members x of subset without another member z below (xRz) or, if maximal,
+ * above (zRx) them. Row x of the table or of the transpose meets subset in x only.
+ */
+static bool
+rf_relation_extremal_elements(const rf_Relation *r, const rf_IndexSet *subset, rf_IndexSet *result,
+                              bool maximal, rf_Error *error) {
+	assert(r != NULL);
+	assert(subset != NULL);
+	assert(result != NULL && result != subset);
+
+	if(!rf_relation_is_homogeneous(r)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return false;
+	}
+	assert(subset->capacity == (int) r->domains[0]->cardinality);
+	assert(result->capacity == subset->capacity);
+
+	const uint64_t *t = maximal ? rf_relation_transpose_cached(r) : r->table;
+
+	rf_index_set_clear(result);
+	for(int x = rf_index_set_next(subset, 0); x >= 0; x = rf_index_set_next(subset, x + 1)) {
+		bool dominated = false;
+		if(t != NULL) {
+			dominated = rf_bitrow_meets(&t[(size_t) x * r->stride], subset->bits, subset->words, x);
+		} else {
+			// without memory for the transpose the column is gathered bit by bit
+			for(size_t w = 0; w < subset->words && !dominated; w++) {
+				uint64_t common = column_word(r, NULL, 0, x, w) & subset->bits[w];
+				if(w == (size_t) x / RF_BITROW_WORD_BITS)
+					common &= ~(UINT64_C(1) << (x % RF_BITROW_WORD_BITS));
+				dominated = common != 0;
+			}
+		}
+		if(!dominated)
+			rf_index_set_add(result, x);
+	}
+
+	return true;
+}
+
+/*
+ * The members of subset that are not above another member. result must not be
+ * subset. Returns false with RF_E_REL_NOT_HOMOGENEOUS.
+ */
+bool
+rf_relation_minimal_elements(const rf_Relation *r, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error) {
+	return rf_relation_extremal_elements(r, subset, result, false, error);
+}
+
+/*
+ * The members of subset that are not below another member. result must not be
+ * subset. Returns false with RF_E_REL_NOT_HOMOGENEOUS.
+ */
+bool
+rf_relation_maximal_elements(const rf_Relation *r, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error) {
+	return rf_relation_extremal_elements(r, subset, result, true, error);
+}
+
+/*
+ * The elements u with uRs for all s of subset: the AND of their columns, taken as
+ * rows of the cached transpose. Every element bounds the empty subset. result must
+ * not be subset. Returns false with RF_E_REL_NOT_HOMOGENEOUS.
+ */
+bool
+rf_relation_upper_bounds(const rf_Relation *r, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error) {
+	assert(r != NULL);
+	assert(subset != NULL);
+	assert(result != NULL && result != subset);
+
+	if(!rf_relation_is_homogeneous(r)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return false;
+	}
+	assert(subset->capacity == (int) r->domains[0]->cardinality);
+	assert(result->capacity == subset->capacity);
+
+	rf_bitrow_set_all(result->bits, result->capacity);
+
+	// without memory for the transpose the columns are gathered bit by bit
+	const uint64_t *t = rf_relation_transpose_cached(r);
+	for(int s = rf_index_set_next(subset, 0); s >= 0; s = rf_index_set_next(subset, s + 1)) {
+		if(t != NULL) {
+			rf_bitrow_and(result->bits, result->bits, &t[(size_t) s * result->words], result->words);
+		} else {
+			for(size_t w = 0; w < result->words; w++)
+				result->bits[w] &= column_word(r, NULL, 0, s, w);
+		}
+	}
+
+	return true;
+}
+
+/*
+ * The elements l with sRl for all s of subset: the AND of their rows. Every element
+ * bounds the empty subset. result must not be subset. Returns false with
+ * RF_E_REL_NOT_HOMOGENEOUS.
+ */
+bool
+rf_relation_lower_bounds(const rf_Relation *r, const rf_IndexSet *subset, rf_IndexSet *result, rf_Error *error) {
+	assert(r != NULL);
+	assert(subset != NULL);
+	assert(result != NULL && result != subset);
+
+	if(!rf_relation_is_homogeneous(r)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return false;
+	}
+	assert(subset->capacity == (int) r->domains[0]->cardinality);
+	assert(result->capacity == subset->capacity);
+
+	rf_bitrow_set_all(result->bits, result->capacity);
+	for(int s = rf_index_set_next(subset, 0); s >= 0; s = rf_index_set_next(subset, s + 1))
+		rf_bitrow_and(result->bits, result->bits, rf_relation_row_const(r, s), result->words);
+
+	return true;
+}
+
+/*
+ * The elements y of domains[1] with xRy for some x of elements: the OR of their rows.
+ */
+void
+rf_relation_image(const rf_Relation *r, const rf_IndexSet *elements, rf_IndexSet *result) {
+	assert(r != NULL);
+	assert(elements != NULL);
+	assert(result != NULL && result != elements);
+	assert(elements->capacity == (int) r->domains[0]->cardinality);
+	assert(result->capacity == (int) r->domains[1]->cardinality);
+
+	rf_index_set_clear(result);
+	for(int x = rf_index_set_next(elements, 0); x >= 0; x = rf_index_set_next(elements, x + 1))
+		rf_bitrow_or(result->bits, result->bits, rf_relation_row_const(r, x), r->stride);
+}
+
+/*
+ * The elements x of domains[0] with xRy for some y of elements: the rows meeting them.
+ */
+void
+rf_relation_preimage(const rf_Relation *r, const rf_IndexSet *elements, rf_IndexSet *result) {
+	assert(r != NULL);
+	assert(elements != NULL);
+	assert(result != NULL && result != elements);
+	assert(elements->capacity == (int) r->domains[1]->cardinality);
+	assert(result->capacity == (int) r->domains[0]->cardinality);
+
+	rf_index_set_clear(result);
+	for(int x = r->domains[0]->cardinality-1; x >= 0; --x) {
+		if(rf_bitrow_meets(rf_relation_row_const(r, x), elements->bits, r->stride, RF_BITROW_NONE))
+			rf_index_set_add(result, x);
+	}
+}
+
+/*
+ * The queries below take and return rf_Set and are built on the ones above. Sets
+ * returned are new, elements returned belong to the domain of r.
+ */
+
+/*
+ * Checks shared by the order queries on rf_Set: r has to be a partial order and s a
+ * subset of its elements. Returns the indices of s, NULL on error.
+ */
+static rf_IndexSet *
+rf_relation_order_subset(const rf_Relation *r, const rf_Set *s, rf_Error *error) {
+	assert(r != NULL);
+	assert(s != NULL);
 
 	if(!rf_relation_is_homogeneous(r)) {
 		if(error != NULL) {
 			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
 		}
-		return returnSet;
+		return NULL;
 	}
+
 	if(!rf_relation_is_partial_order(r)) {
 		if(error != NULL) {
 			rf_error_set(error, RF_E_REL_NOT_ORDERED, "");
 		}
-		return returnSet;
-	}
-
-	if(s->cardinality == 1)
-		return s;
-
-	const int dimS = s->cardinality;
-	for(int x = 0; x < dimS; x++) {
-		bool xRx = false;
-		bool zRx = false;
-		for(int y = 0; y < dimS; y++) {
-			int xr = rf_set_get_element_index(r->domains[0],s->elements[x]);
-			int yr = rf_set_get_element_index(r->domains[1],s->elements[y]);
-			if(r->table[rf_table_idx(r,xr,yr)]) {
-				if(xr == yr)
-					xRx = true;
-				if(xr !=yr)
-					zRx = true;
-			}
-		}
-		if(xRx & !zRx) {
-			mins[returnSet->cardinality] = rf_set_element_clone(s->elements[x]);
-			returnSet->cardinality++;
-		}
+		return NULL;
 	}
 
-	return returnSet;
+	return rf_index_set_new_from_set(s, r->domains[0], error);
+}
+
+/*
+ * The only member of set as an element of the domain of r, NULL unless there is
+ * exactly one.
+ */
+static rf_SetElement *
+rf_relation_single_element(const rf_Relation *r, const rf_IndexSet *set) {
+	const int first = rf_index_set_next(set, 0);
+	if(first < 0 || rf_index_set_next(set, first + 1) >= 0)
+		return NULL;
+
+	return r->domains[0]->elements[first];
+}
+
+/*
+ * The minimal or maximal elements of s as a new set, empty on error.
+ */
+static rf_Set *
+rf_relation_find_extremal_elements(const rf_Relation *r, const rf_Set *s, bool maximal, rf_Error *error) {
+	rf_IndexSet *subset = rf_relation_order_subset(r, s, error);
+	if(subset == NULL)
+		return rf_set_new(0, NULL);
+
+	rf_IndexSet *extremal = rf_index_set_new(subset->capacity);
+	rf_relation_extremal_elements(r, subset, extremal, maximal, error);
+	rf_Set *result = rf_index_set_to_set(extremal, r->domains[0]);
+	if(result == NULL && error != NULL)
+		rf_error_set(error, RF_E_NO_MEMORY, "");
+
+	rf_index_set_free(extremal);
+	rf_index_set_free(subset);
+
+	return result;
+}
+
+/*
+ * The element of s that is the only minimal or maximal one, NULL if there is none.
+ */
+static rf_SetElement *
+rf_relation_find_extremum(const rf_Relation *r, const rf_Set *s, bool maximal, rf_Error *error) {
+	rf_IndexSet *subset = rf_relation_order_subset(r, s, error);
+	if(subset == NULL)
+		return NULL;
+
+	rf_IndexSet *extremal = rf_index_set_new(subset->capacity);
+	rf_relation_extremal_elements(r, subset, extremal, maximal, error);
+	rf_SetElement *extremum = rf_relation_single_element(r, extremal);
+
+	rf_index_set_free(extremal);
+	rf_index_set_free(subset);
+
+	return extremum;
+}
+
+/*
+ * The least upper or greatest lower bound of s, NULL if there is none. The bounds
+ * are found first; the one wanted is the only extremal element among them.
+ */
+static rf_SetElement *
+rf_relation_find_bound_extremum(const rf_Relation *r, const rf_Set *s, bool supremum, rf_Error *error) {
+	rf_IndexSet *subset = rf_relation_order_subset(r, s, error);
+	if(subset == NULL)
+		return NULL;
+
+	rf_IndexSet *bounds = rf_index_set_new(subset->capacity);
+	if(supremum)
+		rf_relation_upper_bounds(r, subset, bounds, error);
+	else
+		rf_relation_lower_bounds(r, subset, bounds, error);
+
+	// subset is done with and takes the extremal bounds
+	rf_relation_extremal_elements(r, bounds, subset, !supremum, error);
+	rf_SetElement *extremum = rf_relation_single_element(r, subset);
+
+	rf_index_set_free(bounds);
+	rf_index_set_free(subset);
+
+	return extremum;
 }
 
-rf_SetElement *
-rf_relation_find_minimum_within_subset(const rf_Relation *r, rf_Set *s, rf_Error *error) {
-	assert(r != NULL);
-	assert(s != NULL);
+/*
+ * The bounds of s as a new set, NULL on error.
+ */
+static rf_Set *
+rf_relation_find_bounds(const rf_Relation *r, const rf_Set *s, bool upper, rf_Error *error) {
+	rf_IndexSet *subset = rf_relation_order_subset(r, s, error);
+	if(subset == NULL)
+		return NULL;
+
+	rf_IndexSet *bounds = rf_index_set_new(subset->capacity);
+	if(upper)
+		rf_relation_upper_bounds(r, subset, bounds, error);
+	else
+		rf_relation_lower_bounds(r, subset, bounds, error);
+	rf_Set *result = rf_index_set_to_set(bounds, r->domains[0]);
+	if(result == NULL && error != NULL)
+		rf_error_set(error, RF_E_NO_MEMORY, "");
 
-	rf_Set *mins = rf_relation_find_minimal_elements(r, s, error);
+	rf_index_set_free(bounds);
+	rf_index_set_free(subset);
+
+	return result;
+}
 
-	if(mins->cardinality == 1)
-		return mins->elements[0];
+rf_Set *
+rf_relation_find_minimal_elements(const rf_Relation *r, rf_Set *s, rf_Error *error) {
+	return rf_relation_find_extremal_elements(r, s, false, error);
+}
 
-	return NULL;
+rf_SetElement *
+rf_relation_find_minimum_within_subset(const rf_Relation *r, rf_Set *s, rf_Error *error) {
+	return rf_relation_find_extremum(r, s, false, error);
 }
 
 /**
@@ -568,63 +1941,12 @@ rf_relation_find_minimum(const rf_Relation *r, rf_Error *error) {
 
 rf_Set *
 rf_relation_find_maximal_elements(const rf_Relation *r, rf_Set *s, rf_Error *error) {
-	assert(r != NULL);
-
-	rf_SetElement **maxs = malloc(sizeof(maxs)*s->cardinality);
-	rf_Set *returnSet = rf_set_new(0, maxs);
-
-	if(!rf_relation_is_homogeneous(r)) {
-		if(error != NULL) {
-			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
-		}
-		return returnSet;
-	}
-	if(!rf_relation_is_partial_order(r)) {
-		if(error != NULL) {
-			rf_error_set(error, RF_E_REL_NOT_ORDERED, "");
-		}
-		return returnSet;
-	}
-
-	if(s->cardinality == 1)
-		return s;
-
-	const int dimS = s->cardinality;
-
-	for(int y = 0; y < dimS; y++) {
-		bool xRx = false;
-		bool zRx = false;
-		for(int x = 0; x < dimS; x++) {
-			int xr = rf_set_get_element_index(r->domains[0],s->elements[x]);
-			int yr = rf_set_get_element_index(r->domains[1],s->elements[y]);
-			if(r->table[rf_table_idx(r,xr,yr)]) {
-				if(xr == yr)
-					xRx = true;
-				if(xr !=yr)
-					zRx = true;
-			}
-		}
-		if(xRx & !zRx) {
-			maxs[returnSet->cardinality] = rf_set_element_clone(s->elements[y]);
-			returnSet->cardinality++;
-		}
-	}
-
-	return returnSet;
+	return rf_relation_find_extremal_elements(r, s, true, error);
 }
 
 rf_SetElement *
 rf_relation_find_maximum_within_subset(const rf_Relation *r, rf_Set *s, rf_Error *error) {
-	assert(r != NULL);
-	assert(s != NULL);
-
-	rf_Set *maxs = rf_relation_find_maximal_elements(r, s, error);
-
-	if(maxs->cardinality == 1)
-		return maxs->elements[0];
-
-
-	return NULL;
+	return rf_relation_find_extremum(r, s, true, error);
 }
 
 /**
@@ -638,86 +1960,115 @@ rf_relation_find_maximum(const rf_Relation *r, rf_Error *error) {
 
 rf_SetElement *
 rf_relation_find_supremum(const rf_Relation *r, const rf_Set *domain, rf_Error *error) {
-	rf_Set *upperbound = rf_relation_find_upperbound(r, domain, error);
-
-	if(upperbound == NULL)
-		return NULL;
-
-	return rf_relation_find_minimum_within_subset(r, upperbound, error);
+	return rf_relation_find_bound_extremum(r, domain, true, error);
 }
 
 rf_SetElement *
 rf_relation_find_infimum(const rf_Relation *r, const rf_Set *domain, rf_Error *error) {
-	rf_Set *lowerbound = rf_relation_find_lowerbound(r, domain, error);
-
-	if(lowerbound == NULL) {
-		return NULL;
-	}
-
-	return rf_relation_find_maximum_within_subset(r, lowerbound, error);
+	return rf_relation_find_bound_extremum(r, domain, false, error);
 }
 
 rf_Set *
 rf_relation_find_upperbound(const rf_Relation *r, const rf_Set *domain, rf_Error *error) {
-	assert(r != NULL);
-	assert(domain != NULL);
+	return rf_relation_find_bounds(r, domain, true, error);
+}
 
-	if(!rf_relation_is_homogeneous(r)) {
-		if(error != NULL) {
-			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
-		}
-		return NULL;
-	}
+rf_Set *
+rf_relation_find_lowerbound(const rf_Relation *r, const rf_Set *domain, rf_Error *error) {
+	return rf_relation_find_bounds(r, domain, false, error);
+}
 
-	if(!rf_relation_is_partial_order(r)) {
-		if(error != NULL) {
-			rf_error_set(error, RF_E_REL_NOT_ORDERED, "");
-		}
-		return NULL;
-	}
 
-	if(!rf_set_is_subset(domain, r->domains[0])) {
-		if(error != NULL) {
-			rf_error_set(error, RF_E_SET_NOT_SUBSET, "");
-		}
-		return NULL;
-	}
+/*
+ * r1 = r1 | r2
+ */
+bool
+rf_relation_make_union(rf_Relation *r1, const rf_Relation *r2, rf_Error *error) {
+	assert(r1 != NULL);
+	assert(r2 != NULL);
 
-	int dim = r->domains[0]->cardinality;
-	int dimSubset = domain->cardinality;
-	int goalPosition = 0;
+	rf_Relation *other = rf_relation_aligned(r2, r1, error);
+	if(other == NULL)
+		return false;
 
-	rf_SetElement **tmp = malloc(sizeof(tmp)*dim);
+	rf_bitrow_or(r1->table, r1->table, other->table, rf_table_words(r1));
+	rf_relation_invalidate(r1);
 
-	for(int x = 0; x < dim; x++) {
-		bool isUpperbound = true;
-		for(int y = 0; y < dimSubset; y++) {
-			int index = rf_set_get_element_index(r->domains[0], domain->elements[y]);
-			if(!r->table[rf_table_idx(r,x,index)]) {
-				isUpperbound = false;
-			}
-		}
-		if(isUpperbound) {
-			tmp[goalPosition] = rf_set_element_clone(r->domains[0]->elements[x]);
-			goalPosition++;
-		}
-	}
+	if(other != r2)
+		rf_relation_free(other);
 
-	return rf_set_new(goalPosition, tmp);
+	return true;
 }
 
-rf_Set *
-rf_relation_find_lowerbound(const rf_Relation *r, const rf_Set *domain, rf_Error *error) {
-	assert(r != NULL);
+/*
+ * r1 = r1 & r2
+ */
+bool
+rf_relation_make_intersection(rf_Relation *r1, const rf_Relation *r2, rf_Error *error) {
+	assert(r1 != NULL);
+	assert(r2 != NULL);
+
+	rf_Relation *other = rf_relation_aligned(r2, r1, error);
+	if(other == NULL)
+		return false;
+
+	rf_bitrow_and(r1->table, r1->table, other->table, rf_table_words(r1));
+	rf_relation_invalidate(r1);
+
+	if(other != r2)
+		rf_relation_free(other);
 
-	//To increase performance, just copy lowerbound algorithm into this function and
-	//switch indizes.
+	return true;
+}
+
+/*
+ * r = ~r, flipped per row so the padding stays zero
+ */
+bool
+rf_relation_make_complement(rf_Relation *r, rf_Error *error) {
+	assert(r != NULL);
 
-	const rf_Relation *converse = rf_relation_new_converse(r, error);
+	for(int x = r->domains[0]->cardinality-1; x >= 0; --x)
+		rf_bitrow_not(rf_relation_row(r, x), r->domains[1]->cardinality);
+	rf_relation_invalidate(r);
 
-	return rf_relation_find_upperbound(converse, domain, error);
+	return true;
 }
 
+/*
+ * r = r^-1, the domains are swapped. Square tables are transposed in place, other
+ * shapes need a second table for the duration of the transpose.
+ */
+bool
+rf_relation_make_converse(rf_Relation *r, rf_Error *error) {
+	assert(r != NULL);
+
+	const size_t dim1 = r->domains[0]->cardinality;
+	const size_t dim2 = r->domains[1]->cardinality;
+
+	if(dim1 == dim2) {
+		rf_bitmatrix_transpose_square(r->table, r->stride, dim1);
+	} else {
+		const size_t stride = rf_bitrow_words(dim1);
+		uint64_t *table = rf_bitrow_alloc(dim2 * stride);
+		if(table == NULL) {
+			if(error != NULL)
+				rf_error_set(error, RF_E_NO_MEMORY, "");
+			return false;
+		}
+		rf_bitmatrix_transpose(table, stride, r->table, r->stride, dim1, dim2);
+		rf_bitrow_free(r->table);
+		r->table = table;
+		r->stride = stride;
+	}
+
+	rf_Set *tmp = r->domains[0];
+	r->domains[0] = r->domains[1];
+	r->domains[1] = tmp;
+	rf_relation_invalidate(r);
+
+	return true;
+}
 
 bool
 rf_relation_make_antisymmetric(rf_Relation *r, bool upper, rf_Error *error) {
@@ -732,11 +2083,11 @@ rf_relation_make_antisymmetric(rf_Relation *r, bool upper, rf_Error *error) {
 	const int dim = r->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
 		for(int y = dim-1; y > x; --y) {
-			if(r->table[rf_table_idx(r, x, y)] && r->table[rf_table_idx(r, y, x)]) {
+			if(rf_relation_get(r, x, y) && rf_relation_get(r, y, x)) {
 				if(upper)
-					r->table[rf_table_idx(r, y, x)] = false;
+					rf_relation_set(r, y, x, false);
 				else
-					r->table[rf_table_idx(r, x, y)] = false;
+					rf_relation_set(r, x, y, false);
 			}
 		}
 	}
@@ -750,51 +2101,125 @@ rf_relation_make_asymmetric(rf_Relation *r, bool upper, rf_Error *error) {
 	return rf_relation_make_irreflexive(r, error) && rf_relation_make_antisymmetric(r, upper, error);
 }
 
+/*
+ * Rewrites the table of r from the classes of uf: xRy iff x and node offset + y are
+ * in one class. Each class gets one bit row of its columns, which is copied to the
+ * rows of its members.
+ */
+static void
+rf_relation_fill_classes(rf_Relation *r, rf_UnionFind *uf, int offset) {
+	const int dim1 = r->domains[0]->cardinality;
+	const int dim2 = r->domains[1]->cardinality;
+	int *class_of = malloc((uf->n > 0 ? uf->n : 1) * sizeof(*class_of));
+	int *column_class = malloc((dim2 > 0 ? dim2 : 1) * sizeof(*column_class));
+	int classes = 0;
+
+	for(int i = 0; i < uf->n; i++)
+		class_of[i] = -1;
+	for(int y = 0; y < dim2; y++) {
+		const int root = rf_union_find_find(uf, offset + y);
+		if(class_of[root] < 0)
+			class_of[root] = classes++;
+		column_class[y] = class_of[root];
+	}
+
+	uint64_t *rows = rf_bitrow_alloc((size_t) classes * r->stride);
+	for(int y = 0; y < dim2; y++)
+		rf_bitrow_set(&rows[(size_t) column_class[y] * r->stride], y);
+
+	for(int x = 0; x < dim1; x++) {
+		const int c = class_of[rf_union_find_find(uf, x)];
+		if(c >= 0)
+			memcpy(rf_relation_row(r, x), &rows[(size_t) c * r->stride], r->stride * sizeof(*rows));
+		else
+			memset(rf_relation_row(r, x), 0, r->stride * sizeof(*rows));
+	}
+
+	rf_bitrow_free(rows);
+	free(column_class);
+	free(class_of);
+	rf_relation_invalidate(r);
+}
+
+/*
+ * With fill, R becomes the least difunctional relation containing it: rows and
+ * columns are the nodes of a bipartite graph with an edge for every xRy, and xRy
+ * holds afterwards iff x and y are connected. Without fill, every column keeps only
+ * its first pair, so no two rows overlap.
+ */
 bool
 rf_relation_make_difunctional(rf_Relation *r, bool fill, rf_Error *error) {
 	assert(r != NULL);
 
-	if(!rf_relation_is_homogeneous(r))
+	if(!rf_relation_is_homogeneous(r)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
 		return false;
+	}
 
 	const int dim = r->domains[0]->cardinality;
 
-	for(int y = 0; y < dim; y++) {
+	if(!fill) {
+		uint64_t *taken = rf_bitrow_alloc(r->stride);
 		for(int x = 0; x < dim; x++) {
-			if(r->table[rf_table_idx(r, x, y)] == true) {
-				for(int z = x+1; z < dim; z++) {
-					if(r->table[rf_table_idx(r,z,y)] == true) {
-						//here we have xRy & zRy, now we equalize the images of x and z
-						if(!fill) {
-							r->table[rf_table_idx(r,z,y)] = false;
-						} else {
-							for(int i = 0; i < dim; i++) {
-								if(r->table[rf_table_idx(r, z, i)] == true) {
-									r->table[rf_table_idx(r, x, i)] = true;
-								} else if(r->table[rf_table_idx(r, x, i)] == true) {
-									r->table[rf_table_idx(r, z, i)] = true;
-								}
-							}
-						}
-					}
-				}
+			uint64_t *rx = rf_relation_row(r, x);
+			for(size_t w = 0; w < r->stride; w++) {
+				const uint64_t row = rx[w];
+				rx[w] &= ~taken[w];
+				taken[w] |= row;
 			}
 		}
+		rf_bitrow_free(taken);
+		rf_relation_invalidate(r);
+		return true;
+	}
+
+	// nodes 0 .. dim-1 are the rows, dim .. 2 dim-1 the columns
+	rf_UnionFind *uf = rf_union_find_new(2 * dim);
+	for(int x = 0; x < dim; x++) {
+		const uint64_t *rx = rf_relation_row_const(r, x);
+		for(size_t w = 0; w < r->stride; w++) {
+			for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1)
+				rf_union_find_union(uf, x, dim + w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits));
+		}
 	}
 
+	rf_relation_fill_classes(r, uf, dim);
+	rf_union_find_free(uf);
+
 	return true;
 }
 
 /*
  * Bezeichnung irreführend. Ist im falle fill = false ein "try_make_equivalent"
+ *
+ * With fill, R becomes the least equivalence containing it, the classes being the
+ * connected components of R.
  */
 bool
 rf_relation_make_equivalent(rf_Relation *r, bool fill, rf_Error *error) {
 	assert(r != NULL);
 
-	rf_relation_make_reflexive(r, error) && rf_relation_make_symmetric(r, fill, error) && rf_relation_make_transitive(r, fill, error);
+	if(!fill || !rf_relation_is_homogeneous(r)) {
+		rf_relation_make_reflexive(r, error) && rf_relation_make_symmetric(r, fill, error) && rf_relation_make_transitive(r, fill, error);
+
+		return rf_relation_is_reflexive(r) && rf_relation_is_symmetric(r) && rf_relation_is_transitive(r);
+	}
+
+	const int dim = r->domains[0]->cardinality;
+	rf_UnionFind *uf = rf_union_find_new(dim);
+	for(int x = 0; x < dim; x++) {
+		const uint64_t *rx = rf_relation_row_const(r, x);
+		for(size_t w = 0; w < r->stride; w++) {
+			for(uint64_t bits = rx[w]; bits != 0; bits &= bits - 1)
+				rf_union_find_union(uf, x, w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits));
+		}
+	}
+
+	rf_relation_fill_classes(r, uf, 0);
+	rf_union_find_free(uf);
 
-	return rf_relation_is_reflexive(r) && rf_relation_is_symmetric(r) && rf_relation_is_transitive(r);
+	return true;
 }
 
 bool
@@ -809,7 +2234,7 @@ rf_relation_make_irreflexive(rf_Relation *r, rf_Error *error) {
 
 	const int dim = r->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
-		r->table[rf_table_idx(r, x, x)] = false;
+		rf_relation_set(r, x, x, false);
 	}
 
 	return true;
@@ -851,7 +2276,7 @@ rf_relation_make_reflexive(rf_Relation *r, rf_Error *error) {
 
 	const int dim = r->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
-		r->table[rf_table_idx(r, x, x)] = true;
+		rf_relation_set(r, x, x, true);
 	}
 
 	return true;
@@ -870,11 +2295,11 @@ rf_relation_make_symmetric(rf_Relation *r, bool fill, rf_Error *error) {
 	const int dim = r->domains[0]->cardinality;
 	for(int x = dim-1; x >= 0; --x) {
 		for(int y = dim-1; y > x; --y) {
-			if(r->table[rf_table_idx(r, x, y)] == r->table[rf_table_idx(r, y, x)])
+			if(rf_relation_get(r, x, y) == rf_relation_get(r, y, x))
 				continue;
 
-			r->table[rf_table_idx(r, x, y)] = fill;
-			r->table[rf_table_idx(r, y, x)] = fill;
+			rf_relation_set(r, x, y, fill);
+			rf_relation_set(r, y, x, fill);
 		}
 	}
 
@@ -894,33 +2319,35 @@ rf_relation_make_transitive(rf_Relation *r, bool fill, rf_Error *error) {
 		return false;
 	}
 
-	if(rf_relation_is_transitive(r))
+	const int dim = r->domains[0]->cardinality;
+
+	if(fill) {
+		if(dim >= SPARSE_CLOSURE_MIN_DIM
+		   && rf_bitrow_count(r->table, rf_table_words(r)) <= (size_t) SPARSE_CLOSURE_MAX_DEGREE * dim
+		   && rf_sparse_relation_close_relation(r, NULL))
+			return true;
+
+		rf_bitmatrix_closure(r->table, r->stride, dim);
+		rf_relation_invalidate(r);
 		return true;
+	}
 
-	const int dim = r->domains[0]->cardinality;
-	for(int x = dim-1; x >= 0; --x) {
-		for(int y = dim-1; y >= 0; --y) {
-			if(x == y)
-				continue;
-			if(!r->table[rf_table_idx(r, x, y)])
-				continue;
-			// xRy exists
-			assert(r->table[rf_table_idx(r, x, y)]);
-			for(int z = dim-1; z >= 0; --z) {
-				if(!r->table[rf_table_idx(r, y, z)])
-					continue;
-				// yRz exists
-				assert(r->table[rf_table_idx(r, y, z)]);
-				if(fill) {
-					r->table[rf_table_idx(r, x, z)] = true;
-				} else {
-					r->table[rf_table_idx(r, y, z)] = false;
-				}
+	/*
+	 * Every pair xRy with x != y and a non empty row y drops all of row y. Repeat until
+	 * that leaves a transitive relation.
+	 */
+	while(!rf_relation_is_transitive(r)) {
+		for(int x = dim-1; x >= 0; --x) {
+			const uint64_t *rx = rf_relation_row_const(r, x);
+			for(int y = dim-1; y >= 0; --y) {
+				if(x != y && rf_bitrow_get(rx, y))
+					memset(rf_relation_row(r, y), 0, r->stride * sizeof(*r->table));
 			}
 		}
+		rf_relation_invalidate(r);
 	}
 
-	return rf_relation_make_transitive(r, fill, error);
+	return true;
 }
 
 int
@@ -940,29 +2367,27 @@ rf_relation_find_transitive_gaps(rf_Relation *r, int *occurrences, rf_Set *gaps,
 	int elemCount = 0;
 
 	for(int x = dim-1; x >= 0; --x) {
+		const uint64_t *rx = rf_relation_row_const(r, x);
 		for(int y = dim-1; y >= 0; --y) {
 			if(x == y)
 				continue;
-			if(!r->table[rf_table_idx(r, x, y)])
+			if(!rf_bitrow_get(rx, y))
 				continue;
 			// xRy exists
-			assert(r->table[rf_table_idx(r, x, y)]);
+			const uint64_t *ry = rf_relation_row_const(r, y);
 			for(int z = dim-1; z >= 0; --z) {
-				if(!r->table[rf_table_idx(r, y, z)])
+				if(!rf_bitrow_get(ry, z))
 					continue;
 				// yRz exists
-				assert(r->table[rf_table_idx(r, y, z)]);
-
-				if(r->table[rf_table_idx(r, x, z)])
+				if(rf_bitrow_get(rx, z))
 					continue;
 				// xRz does not exist
-				assert(!r->table[rf_table_idx(r, x, z)]);
 
 				//transitive gap
-				occurrences[rf_table_idx(r, x, y)]++;
-				occurrences[rf_table_idx(r, y, z)]++;
+				occurrences[x * dim + y]++;
+				occurrences[y * dim + z]++;
 				//printf("transitive gap: %i, %i\n", x,z);
-				if(occurrences[rf_table_idx(r, x, y)] == 1) {
+				if(occurrences[x * dim + y] == 1) {
 					rf_SetElement *tupel[] = {
 						r->domains[0]->elements[x],
 						r->domains[0]->elements[y],
@@ -970,7 +2395,7 @@ rf_relation_find_transitive_gaps(rf_Relation *r, int *occurrences, rf_Set *gaps,
 					elems[elemCount] = rf_set_element_new_set(rf_set_new(2, tupel));
 					elemCount++;
 				}
-				if(occurrences[rf_table_idx(r, y, z)] == 1) {
+				if(occurrences[y * dim + z] == 1) {
 					rf_SetElement *tupel[] = {
 						r->domains[0]->elements[y],
 						r->domains[0]->elements[z],
@@ -985,6 +2410,7 @@ rf_relation_find_transitive_gaps(rf_Relation *r, int *occurrences, rf_Set *gaps,
 	if(gaps != NULL) {
 		gaps->cardinality = elemCount;
 		gaps->elements = elems;
+		rf_set_invalidate(gaps);
 	}
 
 	return numOfGaps;
@@ -1000,9 +2426,10 @@ rf_relation_guess_transitive_core(rf_Relation *r, rf_Error *error) {
 		return NULL;
 	}
 
-	int n = r->domains[0]->cardinality*r->domains[0]->cardinality;
+	const int dim = r->domains[0]->cardinality;
+	int n = dim*dim;
 
-	int *occurrences = malloc(sizeof(int)*n);
+	int *occurrences = calloc(n, sizeof(int));
 
 	int numOfGaps =rf_relation_find_transitive_gaps(r, occurrences, NULL, error);
 
@@ -1014,7 +2441,7 @@ rf_relation_guess_transitive_core(rf_Relation *r, rf_Error *error) {
 
 			}
 		}
-		r->table[biggestOccurrenceIndex] = 0;
+		rf_relation_set(r, biggestOccurrenceIndex / dim, biggestOccurrenceIndex % dim, false);
 		numOfGaps = numOfGaps - occurrences[biggestOccurrenceIndex];
 		occurrences[biggestOccurrenceIndex] = -1;
 	}
@@ -1029,7 +2456,7 @@ rf_relation_guess_transitive_core(rf_Relation *r, rf_Error *error) {
 				biggestOccurrenceIndex = i;
 			}
 		}
-		r->table[biggestOccurrenceIndex] = 0;
+		rf_relation_set(r, biggestOccurrenceIndex / dim, biggestOccurrenceIndex % dim, false);
 		occurrences[biggestOccurrenceIndex] = -1;
 	}
 
@@ -1055,7 +2482,7 @@ rf_relation_find_transitive_hard_core(rf_Relation *relation, rf_Error *error) {
 	rf_Relation *arbeitsrelation = rf_relation_clone(relation);
 	rf_Relation *transitiveCore = NULL;
 
-	int *occurrences = malloc(sizeof(int)*arbeitsrelation->domains[0]->cardinality*arbeitsrelation->domains[0]->cardinality);
+	int *occurrences = calloc(arbeitsrelation->domains[0]->cardinality*arbeitsrelation->domains[0]->cardinality, sizeof(int));
 	rf_Set *gaps = rf_set_new(0, malloc(0));
 	rf_relation_find_transitive_gaps(arbeitsrelation, occurrences, gaps, error);
 
@@ -1078,7 +2505,7 @@ rf_relation_find_transitive_hard_core(rf_Relation *relation, rf_Error *error) {
 			rf_SetElement *tmp = currentCombi->elements[j];
 			int x = rf_set_get_element_index(arbeitsrelation->domains[0], tmp->value.set->elements[0]);
 			int y = rf_set_get_element_index(arbeitsrelation->domains[0], tmp->value.set->elements[1]);
-			arbeitsrelation->table[rf_table_idx(arbeitsrelation, x, y)] = false;
+			rf_relation_set(arbeitsrelation, x, y, false);
 		}
 		//is it a possible core?
 		if(rf_relation_is_transitive(arbeitsrelation) && currentCombi->cardinality < minCombi) {
@@ -1090,7 +2517,7 @@ rf_relation_find_transitive_hard_core(rf_Relation *relation, rf_Error *error) {
 			rf_SetElement *tmp = currentCombi->elements[j];
 			int x = rf_set_get_element_index(arbeitsrelation->domains[0], tmp->value.set->elements[0]);
 			int y = rf_set_get_element_index(arbeitsrelation->domains[0], tmp->value.set->elements[1]);
-			arbeitsrelation->table[rf_table_idx(arbeitsrelation, x, y)] = true;
+			rf_relation_set(arbeitsrelation, x, y, true);
 		}
 	}
 
@@ -1102,107 +2529,45 @@ rf_relation_is_lefttotal(const rf_Relation *relation) {
 	assert(relation != NULL);
 
 	//each x has at least one y
-
-	for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-		bool foundAPartner = false;
-		for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-			if(relation->table[rf_table_idx(relation, x, y)]) {
-				foundAPartner = true;
-				break;
-			}
-		}
-		if(!foundAPartner) {
-			return false;
-		}
-	}
-
-	return true;
+	return rf_relation_test_properties(relation, RF_PROPERTY_LEFTTOTAL) != 0;
 }
 
 bool
 rf_relation_is_functional(const rf_Relation *relation) {
-	assert(relation !=NULL);
-
-	for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-		int partnerCount = 0;
-		for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-			if(relation->table[rf_table_idx(relation, x, y)]) {
-				partnerCount++;
-			}
-		}
-		if(partnerCount > 1) {
-			return false;
-		}
-	}
+	assert(relation != NULL);
 
-	return true;
+	//each x has at most one y
+	return rf_relation_test_properties(relation, RF_PROPERTY_FUNCTIONAL) != 0;
 }
 
 bool
 rf_relation_is_function(const rf_Relation *relation) {
-	assert(relation !=NULL);
-
-	for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-		int partnerCount = 0;
-		for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-			if(relation->table[rf_table_idx(relation, x, y)]) {
-				partnerCount++;
-			}
-		}
-		if(partnerCount != 1) {
-			return false;
-		}
-	}
+	assert(relation != NULL);
 
-	return true;
+	return rf_relation_test_properties(relation, RF_PROPERTY_FUNCTION) != 0;
 }
 
 bool
 rf_relation_is_surjective(const rf_Relation *relation) {
+	assert(relation != NULL);
 
-	assert(relation !=NULL);
-
-	//each x has at least one y
-
-	for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-		int partnerCount = 0;
-		for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-			if(relation->table[rf_table_idx(relation, x, y)]) {
-				partnerCount++;
-			}
-		}
-		if(partnerCount == 0) {
-			return false;
-		}
-	}
-
-	return true;
+	//each y has at least one x
+	return rf_relation_test_properties(relation, RF_PROPERTY_SURJECTIVE) != 0;
 }
 
 bool
 rf_relation_is_injective(const rf_Relation *relation) {
-	assert(relation !=NULL);
+	assert(relation != NULL);
 
 	//each y has not more then one x
-
-	for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-		int partnerCount = 0;
-		for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-			if(relation->table[rf_table_idx(relation,x,y)]) {
-				partnerCount++;
-			}
-		}
-		if(partnerCount > 1) {
-			return false;
-		}
-	}
-
-	return true;
+	return rf_relation_test_properties(relation, RF_PROPERTY_INJECTIVE) != 0;
 }
 
 bool
 rf_relation_is_bijective(const rf_Relation *relation) {
-	return rf_relation_is_injective(relation) && rf_relation_is_surjective(relation);
+	assert(relation != NULL);
+
+	return rf_relation_test_properties(relation, RF_PROPERTY_BIJECTIVE) != 0;
 }
 
 /**
@@ -1210,42 +2575,38 @@ rf_relation_is_bijective(const rf_Relation *relation) {
  */
 bool
 rf_relation_is_lattice(const rf_Relation *relation, rf_Error *error) {
-	//ex. supremum and infimum for all a,b with a,b element of domain
+	return rf_relation_is_lattice_witness(relation, NULL, error);
+}
 
+/*
+ * A partial order is a lattice iff every pair x, y has a supremum and an infimum,
+ * see rf_poset_is_lattice.
+ */
+bool
+rf_relation_is_lattice_witness(const rf_Relation *relation, rf_RelationWitness *witness, rf_Error *error) {
 	assert(relation != NULL);
+
 	if(!rf_relation_is_homogeneous(relation)) {
 		if(error != NULL) {
 			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
 		}
-		return false;
+		return rf_relation_refute(relation, witness, RF_PROPERTY_HOMOGENEOUS, 0, 0);
 	}
 
-	if(!rf_relation_is_partial_order(relation)) {
+	if(!rf_relation_find_witness(relation, RF_PROPERTY_PARTIAL_ORDER, witness)) {
 		if(error != NULL) {
 			rf_error_set(error, RF_E_REL_NOT_ORDERED, "");
 		}
 		return false;
 	}
 
-	int dim = relation->domains[0]->cardinality;
-
-	for(int x = 0; x < dim; x++) {
-		for(int y = x + 1; y < dim; y++) {
-			//check for supremum and infimum
-
-			rf_SetElement *elems[] = {
-				relation->domains[0]->elements[x],
-				relation->domains[0]->elements[y],
-			};
-			rf_Set *subset = rf_set_new(2, elems);
+	rf_Poset *poset = rf_poset_new(relation, error);
+	int pair[2];
+	const bool lattice = rf_poset_is_lattice(poset, pair);
+	rf_poset_free(poset);
 
-			rf_SetElement *sup = rf_relation_find_supremum(relation, subset, error);
-			rf_SetElement *inf = rf_relation_find_infimum(relation, subset, error);
-
-			if(sup == NULL || inf == NULL)
-				return false;
-		}
-	}
+	if(!lattice)
+		return rf_relation_refute(relation, witness, 0, 0, 2, pair[0], pair[1]);
 
 	return true;
 }
@@ -1270,7 +2631,7 @@ rf_relation_is_sublattice(rf_Relation *superlattice, rf_Relation *sublattice, rf
 		for(int y = 0; y < dimSub; y++) {
 			int xSuper = rf_set_get_element_index(superlattice->domains[0], sublattice->domains[0]->elements[x]);
 			int ySuper = rf_set_get_element_index(superlattice->domains[1], sublattice->domains[1]->elements[y]);
-			if(sublattice->table[rf_table_idx(sublattice, x, y)] != superlattice->table[rf_table_idx(superlattice, xSuper, ySuper)]) {
+			if(rf_relation_get(sublattice, x, y) != rf_relation_get(superlattice, xSuper, ySuper)) {
 				return false;
 			}
 		}
@@ -1279,32 +2640,44 @@ rf_relation_is_sublattice(rf_Relation *superlattice, rf_Relation *sublattice, rf
 	return true;
 }
 
+/*
+ * The image or preimage of the members of s, both taken from and restricted to the
+ * members of s, as a new set.
+ */
+static rf_Set *
+rf_relation_get_restricted_image(const rf_Relation *r, const rf_Set *s, bool pre) {
+	assert(r != NULL);
+	assert(s != NULL);
+
+	const rf_Set *from = r->domains[pre ? 1 : 0];
+	const rf_Set *to = r->domains[pre ? 0 : 1];
+
+	rf_IndexSet *elements = rf_index_set_new(from->cardinality);
+	rf_IndexSet *restriction = rf_index_set_new(to->cardinality);
+	rf_IndexSet *image = rf_index_set_new(to->cardinality);
+	rf_index_set_add_set(elements, s, from);
+	rf_index_set_add_set(restriction, s, to);
+
+	if(pre)
+		rf_relation_preimage(r, elements, image);
+	else
+		rf_relation_image(r, elements, image);
+	rf_bitrow_and(image->bits, image->bits, restriction->bits, image->words);
+	rf_Set *result = rf_index_set_to_set(image, to);
+
+	rf_index_set_free(image);
+	rf_index_set_free(restriction);
+	rf_index_set_free(elements);
+
+	return result;
+}
+
 /**
  * The image is a subset of the second domain, containing elements that are referenced by some x.
  */
 rf_Set *
 rf_relation_get_image(const rf_Relation *relation, rf_Set *subrelation) {
-	assert(relation != NULL);
-	assert(subrelation != NULL);
-
-	rf_SetElement **elems = malloc(sizeof(elems)*relation->domains[0]->cardinality);
-
-	int elemCount = 0;
-	for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-		if(!rf_set_contains_element(subrelation, relation->domains[1]->elements[y]))
-			continue;
-		for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-			if(!rf_set_contains_element(subrelation, relation->domains[0]->elements[x]))
-				continue;
-			if(relation->table[rf_table_idx(relation,x,y)]) {
-				elems[elemCount] = rf_set_element_clone(relation->domains[1]->elements[y]);
-				elemCount++;
-				break;
-			}
-		}
-	}
-
-	return rf_set_new(elemCount, elems);
+	return rf_relation_get_restricted_image(relation, subrelation, false);
 }
 
 /**
@@ -1312,36 +2685,19 @@ rf_relation_get_image(const rf_Relation *relation, rf_Set *subrelation) {
  */
 rf_Set *
 rf_relation_get_preImage(const rf_Relation *relation, rf_Set *subrelation) {
-	assert(relation != NULL);
-	assert(subrelation != NULL);
-
-	rf_SetElement **elems = malloc(sizeof(elems)*relation->domains[0]->cardinality);
-
-	int elemCount = 0;
-	for(int x = 0; x < relation->domains[0]->cardinality; x++) {
-		if(!rf_set_contains_element(subrelation, relation->domains[0]->elements[x]))
-			continue;
-		for(int y = 0; y < relation->domains[1]->cardinality; y++) {
-			if(!rf_set_contains_element(subrelation, relation->domains[1]->elements[y]))
-				continue;
-			if(relation->table[rf_table_idx(relation,x,y)]) {
-				elems[elemCount] = rf_set_element_clone(relation->domains[0]->elements[x]);
-				elemCount++;
-				break;
-			}
-		}
-	}
-
-	return rf_set_new(elemCount, elems);
+	return rf_relation_get_restricted_image(relation, subrelation, true);
 }
 
 void
 rf_relation_free(rf_Relation *r) {
 	assert(r != NULL);
 
+	if(r->in_arena)
+		return;
+
 	for(int i = N_DOMAINS-1; i >= 0; --i)
 		rf_set_free(r->domains[i]);
 	free(r->domains);
-	free(r->table);
+	rf_relation_release(r);
 	free(r);
 }
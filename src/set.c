@@ -22,10 +22,47 @@
 #include <assert.h>
 
 #include "set.h"
+#include "atom.h"
 #include "tools.h"
 
+/*
+ * Open addressing over a power of two slots, at most half of them used. A slot holds
+ * the position of a member and its hash, -1 if empty. Equal members share the slot
+ * of the last one, as the linear scan finds that first.
+ */
+struct _rf_set_index {
+	unsigned int    cardinality;    /*!< Of the set when built */
+	rf_SetElement   **elements;     /*!< Of the set when built */
+	size_t          mask;           /*!< Slots - 1 */
+	int             *positions;
+	uint64_t        *hashes;
+};
+
 rf_Set *
 rf_set_new(int n, rf_SetElement *elements[n]) {
+	return rf_set_new_in(NULL, n, elements);
+}
+
+/*
+ * Drops what an arena set holds outside its arena: the index and members that were
+ * not made in the arena.
+ */
+static void
+rf_set_release(void *object) {
+	rf_Set *s = object;
+
+	for(int i = s->cardinality-1; i >= 0; --i) {
+		rf_set_element_free(s->elements[i]);
+	}
+	rf_set_invalidate(s);
+}
+
+/*
+ * Like rf_set_new, with the set in arena; a NULL arena is malloc. NULL if there is
+ * no memory, the elements then stay with the caller.
+ */
+rf_Set *
+rf_set_new_in(rf_Arena *arena, int n, rf_SetElement **elements) {
 	assert(n >= 0);
 	assert(elements != NULL || n == 0);
 
@@ -35,52 +72,217 @@ rf_set_new(int n, rf_SetElement *elements[n]) {
 		}
 	}
 
-	rf_Set *s = malloc(sizeof(*s));
+	rf_Set *s = rf_arena_alloc(arena, sizeof(*s));
+	rf_SetElement **members = arena != NULL ? rf_arena_alloc(arena, n * sizeof(*members)) : calloc(n, sizeof(*members));
+	if(s == NULL || (members == NULL && n > 0)) {
+		if(arena == NULL) {
+			free(members);
+			free(s);
+		}
+		return NULL;
+	}
 	s->cardinality = n;
-	s->elements = calloc(n, sizeof(*s->elements));
+	s->elements = members;
+	s->index = NULL;
+	s->sorted = false;
+	s->in_arena = arena != NULL;
 	for(int i = n-1; i >= 0; --i) {
 		s->elements[i] = elements[i];
 	}
+	// without its release the members from outside would be lost
+	if(arena != NULL && !rf_arena_defer(arena, rf_set_release, s))
+		return NULL;
+
+	return s;
+}
+
+/*
+ * A set of the elements in canonical order. Like rf_set_new it takes ownership of
+ * them; duplicates are freed.
+ */
+rf_Set *
+rf_set_new_sorted(int n, rf_SetElement **elements) {
+	rf_Set *s = rf_set_new(n, elements);
+	rf_set_sort(s);
 
 	return s;
 }
 
 rf_Set *
 rf_set_clone(const rf_Set *s) {
+	return rf_set_clone_in(NULL, s);
+}
+
+rf_Set *
+rf_set_clone_in(rf_Arena *arena, const rf_Set *s) {
 	assert(s != NULL);
 
 	int n = s->cardinality;
 	rf_SetElement *elements[n];
-	for(int i = n-1; i >= 0; --i) {
-		elements[i] = rf_set_element_clone(s->elements[i]);
+	rf_Set *c = NULL;
+	int i;
+	for(i = n-1; i >= 0; --i) {
+		elements[i] = rf_set_element_clone_in(arena, s->elements[i]);
+		if(elements[i] == NULL)
+			break;
+	}
+	if(i < 0)
+		c = rf_set_new_in(arena, n, elements);
+	if(c == NULL) {
+		for(int j = n-1; j > i; --j)
+			rf_set_element_free(elements[j]);
+		return NULL;
+	}
+	c->sorted = s->sorted;
+
+	return c;
+}
+
+/*
+ * The first position from on in the sorted set s whose member is not below e: steps
+ * doubling in length until one overshoots, then a binary search within it.
+ */
+static int
+rf_set_gallop(const rf_Set *s, int from, const rf_SetElement *e) {
+	const int n = s->cardinality;
+	int lo = from;
+	int hi = from;
+	for(int step = 1; hi < n && rf_set_element_compare(s->elements[hi], e) < 0; step *= 2) {
+		lo = hi + 1;
+		hi += step;
+	}
+	if(hi > n)
+		hi = n;
+
+	while(lo < hi) {
+		const int mid = lo + (hi - lo) / 2;
+		if(rf_set_element_compare(s->elements[mid], e) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	return rf_set_new(n, elements);
+	return lo;
 }
 
+/*
+ * The members of s1 that are (keep) or are not (!keep) in s2, in the order of s1.
+ * Sorted sets gallop through s2, the others look each member up.
+ */
+static rf_Set *
+rf_set_new_filtered(const rf_Set *s1, const rf_Set *s2, bool keep) {
+	rf_SetElement **elements = malloc((s1->cardinality > 0 ? s1->cardinality : 1) * sizeof(*elements));
+	const bool sorted = s1->sorted && s2->sorted;
+
+	int count = 0;
+	int j = 0;
+	for(int i = 0; i < s1->cardinality; i++) {
+		bool member;
+		if(sorted) {
+			j = rf_set_gallop(s2, j, s1->elements[i]);
+			member = j < s2->cardinality && rf_set_element_compare(s2->elements[j], s1->elements[i]) == 0;
+		} else {
+			member = rf_set_contains_element(s2, s1->elements[i]);
+		}
+		if(member == keep)
+			elements[count++] = rf_set_element_clone(s1->elements[i]);
+	}
+
+	rf_Set *s = rf_set_new(count, elements);
+	s->sorted = s1->sorted;
+	free(elements);
+
+	return s;
+}
+
+/*
+ * The members of both sets. Sorted sets gallop with the smaller one through the
+ * larger.
+ */
 rf_Set *
 rf_set_new_intersection(const rf_Set *s1, const rf_Set *s2) {
 	assert(s1 != NULL);
 	assert(s2 != NULL);
 
-	int maxElements = (s1->cardinality < s2->cardinality) ? s1->cardinality : s2->cardinality;
-	rf_SetElement *elements[maxElements];
+	if(s1->sorted && s2->sorted && s2->cardinality < s1->cardinality)
+		return rf_set_new_filtered(s2, s1, true);
 
-	int elemCount = 0;
-	for(int i = 0; i < s1->cardinality; i++) {
-		for(int j = 0; j < s2->cardinality; j++) {
-			if(rf_set_element_equal(s1->elements[i], s2->elements[j])) {
-				elements[elemCount] = rf_set_element_clone(s1->elements[i]);
-				elemCount++;
-			}
-		}
+	return rf_set_new_filtered(s1, s2, true);
+}
+
+/*
+ * The members of s1 and then those of s2 not in s1; merged in canonical order if
+ * both are sorted.
+ */
+rf_Set *
+rf_set_new_union(const rf_Set *s1, const rf_Set *s2) {
+	assert(s1 != NULL);
+	assert(s2 != NULL);
+
+	if(!(s1->sorted && s2->sorted)) {
+		rf_Set *rest = rf_set_new_filtered(s2, s1, false);
+		const int n = s1->cardinality + rest->cardinality;
+		rf_SetElement **elements = malloc((n > 0 ? n : 1) * sizeof(*elements));
+		for(int i = s1->cardinality-1; i >= 0; --i)
+			elements[i] = rf_set_element_clone(s1->elements[i]);
+		for(int i = rest->cardinality-1; i >= 0; --i)
+			elements[s1->cardinality + i] = rest->elements[i];
+
+		// rest only lends its members
+		rest->cardinality = 0;
+		rf_set_free(rest);
+
+		rf_Set *s = rf_set_new(n, elements);
+		free(elements);
+		return s;
 	}
 
-	return rf_set_new(elemCount, elements);
+	const int n1 = s1->cardinality;
+	const int n2 = s2->cardinality;
+	rf_SetElement **elements = malloc((n1 + n2 > 0 ? n1 + n2 : 1) * sizeof(*elements));
+
+	int count = 0;
+	int i = 0;
+	int j = 0;
+	while(i < n1 || j < n2) {
+		const int order = i == n1 ? 1 : j == n2 ? -1 : rf_set_element_compare(s1->elements[i], s2->elements[j]);
+		if(order <= 0)
+			elements[count++] = rf_set_element_clone(s1->elements[i++]);
+		else
+			elements[count++] = rf_set_element_clone(s2->elements[j++]);
+		if(order == 0)
+			j++;
+	}
+
+	rf_Set *s = rf_set_new(count, elements);
+	s->sorted = true;
+	free(elements);
+
+	return s;
+}
+
+/*
+ * The members of s1 not in s2.
+ */
+rf_Set *
+rf_set_new_difference(const rf_Set *s1, const rf_Set *s2) {
+	assert(s1 != NULL);
+	assert(s2 != NULL);
+
+	return rf_set_new_filtered(s1, s2, false);
 }
 
 rf_Set *
 rf_set_new_powerset(const rf_Set *s) {
+	return rf_set_new_powerset_in(NULL, s);
+}
+
+/*
+ * The powerset with all its members in arena, which saves 2^n small allocations
+ * per level.
+ */
+rf_Set *
+rf_set_new_powerset_in(rf_Arena *arena, const rf_Set *s) {
 	assert(s != NULL);
 //	assert(SIZE_MAX >> s->cardinality > 0); // size_t has enough bits
 
@@ -110,10 +312,19 @@ rf_set_new_powerset(const rf_Set *s) {
 			.cardinality = ps_elem_n,
 			.elements = ps_elem_elems,
 		};
-		ps_elems[i] = rf_set_element_new_set(&ps_elem);
+		ps_elems[i] = rf_set_element_new_set_in(arena, &ps_elem);
+		if(ps_elems[i] == NULL) {
+			while(++i < (int) ps_n)
+				rf_set_element_free(ps_elems[i]);
+			return NULL;
+		}
 	}
 
-	rf_Set *powerset = rf_set_new(ps_n, ps_elems);
+	rf_Set *powerset = rf_set_new_in(arena, ps_n, ps_elems);
+	if(powerset == NULL) {
+		for(int i = ps_n-1; i >= 0; --i)
+			rf_set_element_free(ps_elems[i]);
+	}
 
 	return powerset;
 }
@@ -124,6 +335,37 @@ rf_set_get_cardinality(const rf_Set *s) {
 	return s->cardinality;
 }
 
+static int
+rf_set_element_compare_qsort(const void *a, const void *b) {
+	return rf_set_element_compare(*(rf_SetElement * const *) a, *(rf_SetElement * const *) b);
+}
+
+/*
+ * Puts the members of s into canonical order and frees duplicates. Positions change,
+ * so this is not for the domains of relations.
+ */
+void
+rf_set_sort(rf_Set *s) {
+	assert(s != NULL);
+
+	if(s->sorted)
+		return;
+
+	qsort(s->elements, s->cardinality, sizeof(*s->elements), rf_set_element_compare_qsort);
+
+	int n = 0;
+	for(int i = 0; i < s->cardinality; i++) {
+		if(n > 0 && rf_set_element_compare(s->elements[n-1], s->elements[i]) == 0)
+			rf_set_element_free(s->elements[i]);
+		else
+			s->elements[n++] = s->elements[i];
+	}
+	s->cardinality = n;
+
+	rf_set_invalidate(s);
+	s->sorted = true;
+}
+
 bool
 rf_set_equal(const rf_Set *a, const rf_Set *b) {
 	assert(a != NULL);
@@ -132,6 +374,9 @@ rf_set_equal(const rf_Set *a, const rf_Set *b) {
 	if(a->cardinality != b->cardinality)
 		return false;
 
+	if(a->sorted && b->sorted)
+		return rf_set_compare(a, b) == 0;
+
 	for(int i = b->cardinality-1; i >= 0; --i) {
 		if(!rf_set_contains_element(a, b->elements[i]))
 			return false;
@@ -140,6 +385,44 @@ rf_set_equal(const rf_Set *a, const rf_Set *b) {
 	return true;
 }
 
+/*
+ * Total order on sets: by cardinality, then by the members in canonical order.
+ * Unsorted sets are compared through sorted copies of their member lists.
+ */
+int
+rf_set_compare(const rf_Set *a, const rf_Set *b) {
+	assert(a != NULL);
+	assert(b != NULL);
+
+	if(a->cardinality != b->cardinality)
+		return a->cardinality < b->cardinality ? -1 : 1;
+
+	const int n = a->cardinality;
+	rf_SetElement **ea = a->elements;
+	rf_SetElement **eb = b->elements;
+	if(!a->sorted) {
+		ea = malloc((n > 0 ? n : 1) * sizeof(*ea));
+		memcpy(ea, a->elements, n * sizeof(*ea));
+		qsort(ea, n, sizeof(*ea), rf_set_element_compare_qsort);
+	}
+	if(!b->sorted) {
+		eb = malloc((n > 0 ? n : 1) * sizeof(*eb));
+		memcpy(eb, b->elements, n * sizeof(*eb));
+		qsort(eb, n, sizeof(*eb), rf_set_element_compare_qsort);
+	}
+
+	int order = 0;
+	for(int i = 0; i < n && order == 0; i++)
+		order = rf_set_element_compare(ea[i], eb[i]);
+
+	if(ea != a->elements)
+		free(ea);
+	if(eb != b->elements)
+		free(eb);
+
+	return order;
+}
+
 bool
 rf_set_is_subset(const rf_Set *subset, const rf_Set *superset) {
 	assert(subset != NULL);
@@ -149,6 +432,16 @@ rf_set_is_subset(const rf_Set *subset, const rf_Set *superset) {
 	if(subset->cardinality > superset->cardinality)
 		return false;
 
+	if(subset->sorted && superset->sorted) {
+		int j = 0;
+		for(int i = 0; i < subset->cardinality; i++) {
+			j = rf_set_gallop(superset, j, subset->elements[i]);
+			if(j == superset->cardinality || rf_set_element_compare(superset->elements[j], subset->elements[i]) != 0)
+				return false;
+		}
+		return true;
+	}
+
 	for(int i = subset->cardinality-1; i >= 0; --i) {
 		if(!rf_set_contains_element(superset, subset->elements[i]))
 			return false;
@@ -165,11 +458,98 @@ rf_set_contains_element(const rf_Set *s, const rf_SetElement *e) {
 	return rf_set_get_element_index(s, e) != -1;
 }
 
+static void
+rf_set_index_free(rf_SetIndex *index) {
+	free(index->hashes);
+	free(index->positions);
+	free(index);
+}
+
+/*
+ * Builds the index of s, NULL if there is no memory for it.
+ */
+static rf_SetIndex *
+rf_set_index_new(const rf_Set *s) {
+	size_t slots = 2;
+	while(slots < 2 * (size_t) s->cardinality)
+		slots *= 2;
+
+	rf_SetIndex *index = malloc(sizeof(*index));
+	if(index == NULL)
+		return NULL;
+	index->cardinality = s->cardinality;
+	index->elements = s->elements;
+	index->mask = slots - 1;
+	index->positions = malloc(slots * sizeof(*index->positions));
+	index->hashes = malloc(slots * sizeof(*index->hashes));
+	if(index->positions == NULL || index->hashes == NULL) {
+		rf_set_index_free(index);
+		return NULL;
+	}
+	memset(index->positions, -1, slots * sizeof(*index->positions));
+
+	for(int i = 0; i < s->cardinality; i++) {
+		const uint64_t hash = rf_set_element_hash(s->elements[i]);
+		size_t slot = hash & index->mask;
+		while(index->positions[slot] >= 0
+		      && !(index->hashes[slot] == hash
+		           && rf_set_element_equal(s->elements[index->positions[slot]], s->elements[i])))
+			slot = (slot + 1) & index->mask;
+		index->positions[slot] = i;
+		index->hashes[slot] = hash;
+	}
+
+	return index;
+}
+
+/*
+ * The index of s, built if it is missing. NULL if there is no memory for it or s has
+ * changed since it was built; lookups then scan. Like the caches of relations it does
+ * not count as part of the value of s.
+ *
+ * Concurrent lookups may race to build it: the first one is published with a
+ * compare and swap, the others free their own copy. Lookups never free a published
+ * index, only rf_set_invalidate does.
+ */
+static const rf_SetIndex *
+rf_set_get_index(const rf_Set *s) {
+	rf_Set *cache = (rf_Set *) s;
+
+	rf_SetIndex *index = __atomic_load_n(&cache->index, __ATOMIC_ACQUIRE);
+	if(index == NULL) {
+		rf_SetIndex *built = rf_set_index_new(s);
+		if(built == NULL)
+			return NULL;
+		if(__atomic_compare_exchange_n(&cache->index, &index, built, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			index = built;
+		else
+			rf_set_index_free(built);
+	}
+
+	if(index->cardinality != s->cardinality || index->elements != s->elements)
+		return NULL;
+
+	return index;
+}
+
+/*
+ * Position of e in s, -1 if it is no member. Large sets answer from their index.
+ */
 int
 rf_set_get_element_index(const rf_Set *s, const rf_SetElement *e) {
 	assert(s != NULL);
 	assert(e != NULL);
 
+	const rf_SetIndex *index = s->cardinality >= RF_SET_INDEX_MIN ? rf_set_get_index(s) : NULL;
+	if(index != NULL) {
+		const uint64_t hash = rf_set_element_hash(e);
+		for(size_t slot = hash & index->mask; index->positions[slot] >= 0; slot = (slot + 1) & index->mask) {
+			if(index->hashes[slot] == hash && rf_set_element_equal(s->elements[index->positions[slot]], e))
+				return index->positions[slot];
+		}
+		return -1;
+	}
+
 	int i;
 	for(i = s->cardinality-1; i >= 0; --i) {
 		if(rf_set_element_equal(s->elements[i], e))
@@ -179,13 +559,28 @@ rf_set_get_element_index(const rf_Set *s, const rf_SetElement *e) {
 	return i;
 }
 
+/*
+ * Drops the index of s and its canonical order. Needed after members were replaced
+ * in place, or cardinality or elements were changed directly.
+ */
+void
+rf_set_invalidate(rf_Set *s) {
+	assert(s != NULL);
+
+	if(s->index != NULL)
+		rf_set_index_free(s->index);
+	s->index = NULL;
+	s->sorted = false;
+}
+
 void
 rf_set_free(rf_Set *s) {
 	assert(s != NULL);
 
-	for(int i = s->cardinality-1; i >= 0; --i) {
-		rf_set_element_free(s->elements[i]);
-	}
+	if(s->in_arena)
+		return;
+
+	rf_set_release(s);
 	free(s->elements);
 	free(s);
 }
@@ -197,37 +592,147 @@ rf_set_free(rf_Set *s) {
 
 rf_SetElement *
 rf_set_element_new_string(char *value) {
+	return rf_set_element_new_string_in(NULL, value);
+}
+
+/*
+ * Gives up the key of an element in an arena.
+ */
+static void
+rf_set_element_release(void *object) {
+	rf_SetElement *e = object;
+
+	rf_atom_release(e->key);
+}
+
+/*
+ * An element in arena holding key, of which it takes over the reference. NULL if
+ * key is NULL or there is no memory.
+ */
+static rf_SetElement *
+rf_set_element_alloc(rf_Arena *arena, rf_SetElementType type, const char *key) {
+	if(key == NULL)
+		return NULL;
+
+	rf_SetElement *e = rf_arena_alloc(arena, sizeof(*e));
+	if(e == NULL) {
+		rf_atom_release(key);
+		return NULL;
+	}
+	if(arena != NULL && !rf_arena_defer(arena, rf_set_element_release, e)) {
+		rf_atom_release(key);
+		return NULL;
+	}
+	e->type = type;
+	e->in_arena = arena != NULL;
+	e->key = key;
+
+	return e;
+}
+
+/*
+ * An element holding the atom of value, NULL if there is no memory for either.
+ */
+rf_SetElement *
+rf_set_element_new_string_in(rf_Arena *arena, const char *value) {
 	assert(value != NULL);
 
-	rf_SetElement *e = malloc(sizeof(*e));
-	e->type = RF_SET_ELEMENT_TYPE_STRING;
-	e->value.string = strdup(value);
+	rf_SetElement *e = rf_set_element_alloc(arena, RF_SET_ELEMENT_TYPE_STRING, rf_atom_intern(value));
+	if(e == NULL)
+		return NULL;
+	e->value.string = e->key;
 
 	return e;
 }
 
+static int
+rf_set_key_compare(const void *a, const void *b) {
+	const uintptr_t x = (uintptr_t) *(const char * const *) a;
+	const uintptr_t y = (uintptr_t) *(const char * const *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * The key of the value of s: the atom of a NUL byte, which starts no string atom,
+ * followed by the keys of the members in address order. Equal sets share it. NULL
+ * if there is no memory.
+ */
+static const char *
+rf_set_value_key(const rf_Set *s) {
+	const size_t n = s->cardinality;
+	const char **keys = malloc((n > 0 ? n : 1) * sizeof(*keys));
+	char *bytes = malloc(1 + n * sizeof(*keys));
+	if(keys == NULL || bytes == NULL) {
+		free(keys);
+		free(bytes);
+		return NULL;
+	}
+	for(size_t i = 0; i < n; ++i)
+		keys[i] = s->elements[i]->key;
+	qsort(keys, n, sizeof(*keys), rf_set_key_compare);
+
+	bytes[0] = '\0';
+	memcpy(bytes + 1, keys, n * sizeof(*keys));
+	const char *key = rf_atom_intern_bytes(bytes, 1 + n * sizeof(*keys));
+	free(bytes);
+	free(keys);
+
+	return key;
+}
+
 rf_SetElement *
 rf_set_element_new_set(rf_Set *value) {
+	return rf_set_element_new_set_in(NULL, value);
+}
+
+/*
+ * An element holding a copy of value, the copy and its members in arena. NULL if
+ * there is no memory.
+ */
+rf_SetElement *
+rf_set_element_new_set_in(rf_Arena *arena, const rf_Set *value) {
 	assert(value != NULL);
 
-	rf_SetElement *e = malloc(sizeof(*e));
-	e->type = RF_SET_ELEMENT_TYPE_SET;
-	e->value.set = rf_set_clone(value);
+	rf_Set *set = rf_set_clone_in(arena, value);
+	if(set == NULL)
+		return NULL;
+	rf_SetElement *e = rf_set_element_alloc(arena, RF_SET_ELEMENT_TYPE_SET, rf_set_value_key(set));
+	if(e == NULL) {
+		rf_set_free(set);
+		return NULL;
+	}
+	e->value.set = set;
 
 	return e;
 }
 
 rf_SetElement *
 rf_set_element_clone(const rf_SetElement *e) {
+	return rf_set_element_clone_in(NULL, e);
+}
+
+rf_SetElement *
+rf_set_element_clone_in(rf_Arena *arena, const rf_SetElement *e) {
 	assert(e != NULL);
 
 	rf_SetElement *c;
+	rf_Set *set;
 	switch(e->type) {
 	case RF_SET_ELEMENT_TYPE_STRING:
-		c = rf_set_element_new_string(e->value.string);
+		c = rf_set_element_alloc(arena, RF_SET_ELEMENT_TYPE_STRING, rf_atom_acquire(e->key));
+		if(c != NULL)
+			c->value.string = c->key;
 		break;
 	case RF_SET_ELEMENT_TYPE_SET:
-		c = rf_set_element_new_set(e->value.set);
+		set = rf_set_clone_in(arena, e->value.set);
+		if(set == NULL)
+			return NULL;
+		c = rf_set_element_alloc(arena, RF_SET_ELEMENT_TYPE_SET, rf_atom_acquire(e->key));
+		if(c == NULL)
+			rf_set_free(set);
+		else
+			c->value.set = set;
 		break;
 	default:
 		assert(false); // all cases must be handled
@@ -242,34 +747,62 @@ rf_set_element_equal(const rf_SetElement *a, const rf_SetElement *b) {
 	assert(a != NULL);
 	assert(b != NULL);
 
+	// equal values share their key
+	return a->type == b->type && a->key == b->key;
+}
+
+/*
+ * Hash consistent with rf_set_element_equal: the one of the key.
+ */
+uint64_t
+rf_set_element_hash(const rf_SetElement *e) {
+	assert(e != NULL);
+
+	return rf_atom_hash(e->key);
+}
+
+/*
+ * Total order on elements, consistent with rf_set_element_equal: strings before sets,
+ * strings by strcmp, sets by rf_set_compare.
+ */
+int
+rf_set_element_compare(const rf_SetElement *a, const rf_SetElement *b) {
+	assert(a != NULL);
+	assert(b != NULL);
+
 	if(a->type != b->type)
-		return false;
+		return a->type < b->type ? -1 : 1;
+	if(a->key == b->key)
+		return 0;
 
 	switch(a->type) {
 	case RF_SET_ELEMENT_TYPE_STRING:
-	{
-		return strcmp(a->value.string, b->value.string) == 0;
-	}
+		return strcmp(a->value.string, b->value.string);
 
 	case RF_SET_ELEMENT_TYPE_SET:
-		return rf_set_equal(a->value.set, b->value.set);
+		return rf_set_compare(a->value.set, b->value.set);
+
 	default:
 		assert(false); // all cases must be handled
 	}
 
-	return false;
+	return 0;
 }
 
 void
 rf_set_element_free(rf_SetElement *e) {
 	assert(e != NULL);
 
+	if(e->in_arena)
+		return;
+
 	switch(e->type) {
 	case RF_SET_ELEMENT_TYPE_STRING:
-		free(e->value.string);
+		rf_atom_release(e->value.string);
 		break;
 	case RF_SET_ELEMENT_TYPE_SET:
 		rf_set_free(e->value.set);
+		rf_atom_release(e->key);
 		break;
 	default:
 		assert(false); // all cases must be handled
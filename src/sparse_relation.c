@@ -0,0 +1,552 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "sparse_relation.h"
+
+#define N_DOMAINS 2
+
+/*
+ * Strongly connected components of a graph in adjacency lists and the reachability
+ * between them. Components are numbered in the order Tarjan's algorithm completes
+ * them, so every edge between two components goes from a higher to a lower number.
+ */
+typedef struct {
+	int             count;
+	int             *component;     /* element -> component */
+	size_t          *members_at;    /* count + 1 starts into members */
+	int             *members;       /* elements grouped by component, ascending */
+	bool            *cyclic;        /* component reaches itself */
+	size_t          *reach_at;      /* count + 1 starts into reach */
+	int             *reach;         /* closed ranges lo, hi of components reached in one or more steps, the component itself excluded */
+} rf_Condensation;
+
+static int
+compare_int(const void *a, const void *b) {
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Sorts every row and drops duplicates. offsets and targets are compacted in place.
+ */
+static void
+normalize_rows(int n, size_t *offsets, int *targets) {
+	size_t out = 0;
+	size_t start = 0;
+
+	for(int x = 0; x < n; x++) {
+		const size_t end = offsets[x+1];
+		qsort(&targets[start], end - start, sizeof(*targets), compare_int);
+		offsets[x] = out;
+		for(size_t i = start; i < end; i++) {
+			if(i == start || targets[i] != targets[i-1])
+				targets[out++] = targets[i];
+		}
+		start = end;
+	}
+	offsets[n] = out;
+}
+
+/*
+ * Adjacency lists of the bit table of r, false if out of memory.
+ */
+static bool
+lists_from_table(const rf_Relation *r, size_t **offsets, int **targets) {
+	const int dim1 = r->domains[0]->cardinality;
+	const size_t words = (r->domains[1]->cardinality + RF_BITROW_WORD_BITS-1) / RF_BITROW_WORD_BITS;
+
+	*offsets = malloc((dim1 + 1) * sizeof(**offsets));
+	if(*offsets == NULL)
+		return false;
+
+	(*offsets)[0] = 0;
+	for(int x = 0; x < dim1; x++)
+		(*offsets)[x+1] = (*offsets)[x] + rf_bitrow_count(rf_relation_row_const(r, x), words);
+
+	*targets = malloc(((*offsets)[dim1] > 0 ? (*offsets)[dim1] : 1) * sizeof(**targets));
+	if(*targets == NULL) {
+		free(*offsets);
+		return false;
+	}
+
+	for(int x = 0; x < dim1; x++) {
+		const uint64_t *row = rf_relation_row_const(r, x);
+		size_t i = (*offsets)[x];
+		for(size_t w = 0; w < words; w++) {
+			for(uint64_t bits = row[w]; bits != 0; bits &= bits - 1)
+				(*targets)[i++] = w * RF_BITROW_WORD_BITS + rf_bitrow_ctz(bits);
+		}
+	}
+
+	return true;
+}
+
+static void
+rf_condensation_free(rf_Condensation *c) {
+	free(c->component);
+	free(c->members_at);
+	free(c->members);
+	free(c->cyclic);
+	free(c->reach_at);
+	free(c->reach);
+}
+
+/*
+ * Tarjan's algorithm with an explicit call stack, so deep chains cannot overflow the
+ * C stack. Fills component, count and cyclic.
+ */
+static bool
+find_components(int n, const size_t *offsets, const int *targets, rf_Condensation *c) {
+	int *index = malloc((n > 0 ? n : 1) * sizeof(*index));
+	int *low = malloc((n > 0 ? n : 1) * sizeof(*low));
+	bool *on_stack = calloc(n > 0 ? n : 1, sizeof(*on_stack));
+	int *stack = malloc((n > 0 ? n : 1) * sizeof(*stack));
+	int *call_v = malloc((n > 0 ? n : 1) * sizeof(*call_v));
+	size_t *call_e = malloc((n > 0 ? n : 1) * sizeof(*call_e));
+	c->component = malloc((n > 0 ? n : 1) * sizeof(*c->component));
+	c->cyclic = calloc(n > 0 ? n : 1, sizeof(*c->cyclic));
+
+	const bool ok = index && low && on_stack && stack && call_v && call_e && c->component && c->cyclic;
+	if(ok) {
+		int counter = 0, top = 0, depth = 0;
+		c->count = 0;
+		for(int v = 0; v < n; v++)
+			index[v] = -1;
+
+		for(int s = 0; s < n; s++) {
+			if(index[s] >= 0)
+				continue;
+
+			index[s] = low[s] = counter++;
+			stack[top++] = s;
+			on_stack[s] = true;
+			call_v[depth] = s;
+			call_e[depth++] = offsets[s];
+
+			while(depth > 0) {
+				const int v = call_v[depth-1];
+				if(call_e[depth-1] < offsets[v+1]) {
+					const int w = targets[call_e[depth-1]++];
+					if(index[w] < 0) {
+						index[w] = low[w] = counter++;
+						stack[top++] = w;
+						on_stack[w] = true;
+						call_v[depth] = w;
+						call_e[depth++] = offsets[w];
+					} else if(on_stack[w] && index[w] < low[v]) {
+						low[v] = index[w];
+					}
+					continue;
+				}
+
+				depth--;
+				if(low[v] == index[v]) {
+					int w, size = 0;
+					do {
+						w = stack[--top];
+						on_stack[w] = false;
+						c->component[w] = c->count;
+						size++;
+					} while(w != v);
+					c->cyclic[c->count++] = size > 1;
+				}
+				if(depth > 0 && low[v] < low[call_v[depth-1]])
+					low[call_v[depth-1]] = low[v];
+			}
+		}
+
+		for(int v = 0; v < n; v++) {
+			if(bsearch(&v, &targets[offsets[v]], offsets[v+1] - offsets[v], sizeof(*targets), compare_int) != NULL)
+				c->cyclic[c->component[v]] = true;
+		}
+	}
+
+	free(index);
+	free(low);
+	free(on_stack);
+	free(stack);
+	free(call_v);
+	free(call_e);
+
+	return ok;
+}
+
+/*
+ * Groups the elements by component with a counting sort, which keeps them ascending.
+ */
+static bool
+group_members(int n, rf_Condensation *c) {
+	c->members_at = calloc(c->count + 1, sizeof(*c->members_at));
+	c->members = malloc((n > 0 ? n : 1) * sizeof(*c->members));
+	size_t *next = malloc((c->count > 0 ? c->count : 1) * sizeof(*next));
+	if(c->members_at == NULL || c->members == NULL || next == NULL) {
+		free(next);
+		return false;
+	}
+
+	for(int v = 0; v < n; v++)
+		c->members_at[c->component[v] + 1]++;
+	for(int k = 0; k < c->count; k++) {
+		c->members_at[k+1] += c->members_at[k];
+		next[k] = c->members_at[k];
+	}
+	for(int v = 0; v < n; v++)
+		c->members[next[c->component[v]]++] = v;
+
+	free(next);
+	return true;
+}
+
+/*
+ * Closes the condensation. Successors of a component have lower numbers and are done
+ * when it is reached, so its ranges are the merge of {d} and the ranges of d over all
+ * successor components d.
+ */
+static bool
+close_components(const size_t *offsets, const int *targets, rf_Condensation *c) {
+	size_t capacity = 64, used = 0;
+	size_t scratch_capacity = 64;
+	int *scratch = malloc(scratch_capacity * sizeof(*scratch));
+	int *seen = malloc((c->count > 0 ? c->count : 1) * sizeof(*seen));
+	c->reach_at = malloc((c->count + 1) * sizeof(*c->reach_at));
+	c->reach = malloc(capacity * sizeof(*c->reach));
+
+	bool ok = scratch && seen && c->reach_at && c->reach;
+	for(int k = 0; ok && k < c->count; k++)
+		seen[k] = -1;
+
+	for(int k = 0; ok && k < c->count; k++) {
+		size_t n_scratch = 0;
+		c->reach_at[k] = used;
+
+		for(size_t m = c->members_at[k]; ok && m < c->members_at[k+1]; m++) {
+			const int v = c->members[m];
+			for(size_t e = offsets[v]; ok && e < offsets[v+1]; e++) {
+				const int d = c->component[targets[e]];
+				if(d == k || seen[d] == k)
+					continue;
+				seen[d] = k;
+
+				const size_t need = n_scratch + 2 + (c->reach_at[d+1] - c->reach_at[d]);
+				if(need > scratch_capacity) {
+					while(need > scratch_capacity)
+						scratch_capacity *= 2;
+					int *grown = realloc(scratch, scratch_capacity * sizeof(*scratch));
+					if(grown == NULL) {
+						ok = false;
+						break;
+					}
+					scratch = grown;
+				}
+				scratch[n_scratch++] = d;
+				scratch[n_scratch++] = d;
+				memcpy(&scratch[n_scratch], &c->reach[c->reach_at[d]],
+				       (c->reach_at[d+1] - c->reach_at[d]) * sizeof(*scratch));
+				n_scratch += c->reach_at[d+1] - c->reach_at[d];
+			}
+		}
+		if(!ok)
+			break;
+
+		// ranges are pairs of ints, ordered by their low end
+		qsort(scratch, n_scratch / 2, 2 * sizeof(*scratch), compare_int);
+
+		if(used + n_scratch > capacity) {
+			while(used + n_scratch > capacity)
+				capacity *= 2;
+			int *grown = realloc(c->reach, capacity * sizeof(*c->reach));
+			if(grown == NULL) {
+				ok = false;
+				break;
+			}
+			c->reach = grown;
+		}
+		for(size_t i = 0; i < n_scratch; i += 2) {
+			if(used > c->reach_at[k] && scratch[i] <= c->reach[used-1] + 1) {
+				if(scratch[i+1] > c->reach[used-1])
+					c->reach[used-1] = scratch[i+1];
+			} else {
+				c->reach[used++] = scratch[i];
+				c->reach[used++] = scratch[i+1];
+			}
+		}
+		c->reach_at[k+1] = used;
+	}
+
+	free(scratch);
+	free(seen);
+
+	return ok;
+}
+
+static bool
+rf_condensation_init(rf_Condensation *c, int n, const size_t *offsets, const int *targets) {
+	memset(c, 0, sizeof(*c));
+
+	if(find_components(n, offsets, targets, c) && group_members(n, c) && close_components(offsets, targets, c))
+		return true;
+
+	rf_condensation_free(c);
+	return false;
+}
+
+/*
+ * Number of elements the members of component k are related to in the closure.
+ */
+static size_t
+closure_size(const rf_Condensation *c, int k) {
+	size_t size = c->cyclic[k] ? c->members_at[k+1] - c->members_at[k] : 0;
+
+	for(size_t i = c->reach_at[k]; i < c->reach_at[k+1]; i += 2)
+		size += c->members_at[c->reach[i+1] + 1] - c->members_at[c->reach[i]];
+
+	return size;
+}
+
+
+rf_SparseRelation *
+rf_sparse_relation_new(rf_Set *d1, rf_Set *d2, size_t count, const int *x, const int *y) {
+	assert(d1 != NULL);
+	assert(d2 != NULL);
+	assert(count == 0 || (x != NULL && y != NULL));
+
+	const int dim1 = d1->cardinality;
+
+	rf_SparseRelation *r = malloc(sizeof(*r));
+	r->domains = calloc(N_DOMAINS, sizeof(*r->domains));
+	r->domains[0] = rf_set_clone(d1);
+	r->domains[1] = rf_set_clone(d2);
+	r->offsets = calloc(dim1 + 1, sizeof(*r->offsets));
+	r->targets = malloc((count > 0 ? count : 1) * sizeof(*r->targets));
+
+	for(size_t i = 0; i < count; i++) {
+		assert(x[i] >= 0 && x[i] < dim1);
+		assert(y[i] >= 0 && y[i] < d2->cardinality);
+		r->offsets[x[i] + 1]++;
+	}
+	for(int v = 0; v < dim1; v++)
+		r->offsets[v+1] += r->offsets[v];
+
+	size_t *fill = malloc((dim1 + 1) * sizeof(*fill));
+	memcpy(fill, r->offsets, (dim1 + 1) * sizeof(*fill));
+	for(size_t i = 0; i < count; i++)
+		r->targets[fill[x[i]]++] = y[i];
+	free(fill);
+
+	normalize_rows(dim1, r->offsets, r->targets);
+
+	return r;
+}
+
+rf_SparseRelation *
+rf_sparse_relation_new_from_relation(const rf_Relation *relation) {
+	assert(relation != NULL);
+
+	rf_SparseRelation *r = malloc(sizeof(*r));
+	r->domains = calloc(N_DOMAINS, sizeof(*r->domains));
+	if(!lists_from_table(relation, &r->offsets, &r->targets)) {
+		free(r->domains);
+		free(r);
+		return NULL;
+	}
+	r->domains[0] = rf_set_clone(relation->domains[0]);
+	r->domains[1] = rf_set_clone(relation->domains[1]);
+
+	return r;
+}
+
+/*
+ * The closure as a new sparse relation. Every component gets its row built and sorted
+ * once, all further members copy it.
+ */
+rf_SparseRelation *
+rf_sparse_relation_new_closure(const rf_SparseRelation *relation, rf_Error *error) {
+	assert(relation != NULL);
+
+	if(!rf_set_equal(relation->domains[0], relation->domains[1])) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return NULL;
+	}
+
+	const int dim = relation->domains[0]->cardinality;
+	rf_Condensation c;
+	if(!rf_condensation_init(&c, dim, relation->offsets, relation->targets)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
+
+	rf_SparseRelation *r = malloc(sizeof(*r));
+	r->domains = calloc(N_DOMAINS, sizeof(*r->domains));
+	r->offsets = malloc((dim + 1) * sizeof(*r->offsets));
+	r->targets = NULL;
+	if(r->offsets != NULL) {
+		r->offsets[0] = 0;
+		for(int v = 0; v < dim; v++)
+			r->offsets[v+1] = r->offsets[v] + closure_size(&c, c.component[v]);
+		r->targets = malloc((r->offsets[dim] > 0 ? r->offsets[dim] : 1) * sizeof(*r->targets));
+	}
+	if(r->targets == NULL) {
+		rf_condensation_free(&c);
+		free(r->offsets);
+		free(r->domains);
+		free(r);
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return NULL;
+	}
+
+	for(int k = 0; k < c.count; k++) {
+		const size_t first = c.members_at[k];
+		int *row = &r->targets[r->offsets[c.members[first]]];
+		size_t size = 0;
+
+		if(c.cyclic[k]) {
+			for(size_t m = c.members_at[k]; m < c.members_at[k+1]; m++)
+				row[size++] = c.members[m];
+		}
+		for(size_t i = c.reach_at[k]; i < c.reach_at[k+1]; i += 2) {
+			for(size_t m = c.members_at[c.reach[i]]; m < c.members_at[c.reach[i+1] + 1]; m++)
+				row[size++] = c.members[m];
+		}
+		qsort(row, size, sizeof(*row), compare_int);
+
+		for(size_t m = first + 1; m < c.members_at[k+1]; m++)
+			memcpy(&r->targets[r->offsets[c.members[m]]], row, size * sizeof(*row));
+	}
+
+	rf_condensation_free(&c);
+	r->domains[0] = rf_set_clone(relation->domains[0]);
+	r->domains[1] = rf_set_clone(relation->domains[1]);
+
+	return r;
+}
+
+rf_Relation *
+rf_sparse_relation_to_relation(const rf_SparseRelation *relation) {
+	assert(relation != NULL);
+
+	rf_Relation *r = rf_relation_new_empty(relation->domains[0], relation->domains[1]);
+
+	for(int x = relation->domains[0]->cardinality-1; x >= 0; --x) {
+		uint64_t *row = rf_relation_row(r, x);
+		for(size_t i = relation->offsets[x]; i < relation->offsets[x+1]; i++)
+			rf_bitrow_set(row, relation->targets[i]);
+	}
+
+	return r;
+}
+
+bool
+rf_sparse_relation_get(const rf_SparseRelation *relation, int x, int y) {
+	assert(relation != NULL);
+	assert(x >= 0 && x < relation->domains[0]->cardinality);
+	assert(y >= 0 && y < relation->domains[1]->cardinality);
+
+	const size_t start = relation->offsets[x];
+
+	return bsearch(&y, &relation->targets[start], relation->offsets[x+1] - start,
+	               sizeof(*relation->targets), compare_int) != NULL;
+}
+
+size_t
+rf_sparse_relation_count(const rf_SparseRelation *relation) {
+	assert(relation != NULL);
+
+	return relation->offsets[relation->domains[0]->cardinality];
+}
+
+/*
+ * Replaces the homogeneous relation r by its transitive closure, computed on the
+ * condensation of its adjacency lists. Every component gets its row built once in the
+ * row of its first member and copied to the others. Pays off for relations with few
+ * pairs per element; on failure r is left unchanged.
+ */
+bool
+rf_sparse_relation_close_relation(rf_Relation *r, rf_Error *error) {
+	assert(r != NULL);
+
+	if(!rf_relation_is_homogeneous(r)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_REL_NOT_HOMOGENEOUS, "");
+		return false;
+	}
+
+	const int dim = r->domains[0]->cardinality;
+	size_t *offsets;
+	int *targets;
+	rf_Condensation c;
+
+	if(!lists_from_table(r, &offsets, &targets)) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return false;
+	}
+	const bool ok = rf_condensation_init(&c, dim, offsets, targets);
+	free(offsets);
+	free(targets);
+	if(!ok) {
+		if(error != NULL)
+			rf_error_set(error, RF_E_NO_MEMORY, "");
+		return false;
+	}
+
+	memset(r->table, 0, (size_t) dim * r->stride * sizeof(*r->table));
+
+	for(int k = 0; k < c.count; k++) {
+		const size_t first = c.members_at[k];
+		uint64_t *row = rf_relation_row(r, c.members[first]);
+
+		if(c.cyclic[k]) {
+			for(size_t m = c.members_at[k]; m < c.members_at[k+1]; m++)
+				rf_bitrow_set(row, c.members[m]);
+		}
+		for(size_t i = c.reach_at[k]; i < c.reach_at[k+1]; i += 2) {
+			for(size_t m = c.members_at[c.reach[i]]; m < c.members_at[c.reach[i+1] + 1]; m++)
+				rf_bitrow_set(row, c.members[m]);
+		}
+
+		for(size_t m = first + 1; m < c.members_at[k+1]; m++)
+			memcpy(rf_relation_row(r, c.members[m]), row, r->stride * sizeof(*row));
+	}
+	rf_relation_invalidate(r);
+
+	rf_condensation_free(&c);
+
+	return true;
+}
+
+void
+rf_sparse_relation_free(rf_SparseRelation *relation) {
+	assert(relation != NULL);
+
+	rf_set_free(relation->domains[0]);
+	rf_set_free(relation->domains[1]);
+	free(relation->domains);
+	free(relation->offsets);
+	free(relation->targets);
+	free(relation);
+}
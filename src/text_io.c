@@ -5,8 +5,6 @@
 
 #include "text_io.h"
 
-extern size_t rf_table_idx(rf_Relation *, ...);
-
 struct strbuf {
 	size_t  size;
 	size_t  cur;
@@ -16,7 +14,7 @@ struct strbuf {
 void strbuf_append_set(struct strbuf *, rf_Set *);
 
 void
-strbuf_append_string(struct strbuf *buf, char *str) {
+strbuf_append_string(struct strbuf *buf, const char *str) {
 #define remaining(strbuf) (strbuf->size - strbuf->cur)
 	int written;
 	while((written = snprintf(&buf->str[buf->cur], remaining(buf), "%s", str)) >= remaining(buf)) {
@@ -62,7 +60,7 @@ strbuf_append_relation(struct strbuf *buf, rf_Relation *r) {
 	for(int x = 0; x < r->domains[0]->cardinality; x++) {
 		for(int y = 0; y < r->domains[1]->cardinality; y++) {
 			strbuf_append_string(buf,
-				(r->table[rf_table_idx(r, x, y)]) ? "1" : "0"
+				rf_relation_get(r, x, y) ? "1" : "0"
 			);
 		}
 		strbuf_append_string(buf, "|\n|");
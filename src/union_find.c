@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2011,2013 Peter Berger, Wilke Schwiedop
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "union_find.h"
+
+/*
+ * n classes of one number each.
+ */
+rf_UnionFind *
+rf_union_find_new(int n) {
+	assert(n >= 0);
+
+	rf_UnionFind *uf = malloc(sizeof(*uf));
+	uf->n = n;
+	uf->parent = malloc((n > 0 ? n : 1) * sizeof(*uf->parent));
+	uf->size = malloc((n > 0 ? n : 1) * sizeof(*uf->size));
+	for(int x = 0; x < n; x++) {
+		uf->parent[x] = x;
+		uf->size[x] = 1;
+	}
+
+	return uf;
+}
+
+/*
+ * Representative of the class of x. Every node on the way up is pointed to its
+ * grandparent, which halves the path for the next search.
+ */
+int
+rf_union_find_find(rf_UnionFind *uf, int x) {
+	assert(uf != NULL);
+	assert(x >= 0 && x < uf->n);
+
+	while(uf->parent[x] != x) {
+		uf->parent[x] = uf->parent[uf->parent[x]];
+		x = uf->parent[x];
+	}
+
+	return x;
+}
+
+/*
+ * Unites the classes of x and y, the smaller one is hung below the larger one.
+ * Returns false if they already were one class.
+ */
+bool
+rf_union_find_union(rf_UnionFind *uf, int x, int y) {
+	assert(uf != NULL);
+
+	x = rf_union_find_find(uf, x);
+	y = rf_union_find_find(uf, y);
+	if(x == y)
+		return false;
+
+	if(uf->size[x] < uf->size[y]) {
+		int tmp = x;
+		x = y;
+		y = tmp;
+	}
+	uf->parent[y] = x;
+	uf->size[x] += uf->size[y];
+
+	return true;
+}
+
+void
+rf_union_find_free(rf_UnionFind *uf) {
+	assert(uf != NULL);
+
+	free(uf->size);
+	free(uf->parent);
+	free(uf);
+}
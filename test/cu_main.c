@@ -5,6 +5,14 @@ extern CU_ErrorCode register_suites_set(void);
 extern CU_ErrorCode register_suites_relation(void);
 extern CU_ErrorCode register_suites_tools(void);
 extern CU_ErrorCode register_suites_text_io(void);
+extern CU_ErrorCode register_suites_sparse_relation(void);
+extern CU_ErrorCode register_suites_closure(void);
+extern CU_ErrorCode register_suites_union_find(void);
+extern CU_ErrorCode register_suites_poset(void);
+extern CU_ErrorCode register_suites_lattice(void);
+extern CU_ErrorCode register_suites_index_set(void);
+extern CU_ErrorCode register_suites_atom(void);
+extern CU_ErrorCode register_suites_arena(void);
 
 int
 main() {
@@ -14,9 +22,17 @@ main() {
 
 	/* add a suites to the registry */
 	if(CUE_SUCCESS != register_suites_set()) goto cleanup;
-//	if(CUE_SUCCESS != register_suites_relation()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_relation()) goto cleanup;
 	if(CUE_SUCCESS != register_suites_tools()) goto cleanup;
 	if(CUE_SUCCESS != register_suites_text_io()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_sparse_relation()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_closure()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_union_find()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_poset()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_lattice()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_index_set()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_atom()) goto cleanup;
+	if(CUE_SUCCESS != register_suites_arena()) goto cleanup;
 
 	/* Run all tests using the CUnit Basic interface */
 	CU_basic_set_mode(CU_BRM_VERBOSE);
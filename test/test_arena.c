@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <CUnit/CUnit.h>
+
+#include "arena.h"
+#include "atom.h"
+#include "set.h"
+#include "relation.h"
+
+static int released[3];
+static int release_count;
+
+static void
+record_release(void *object) {
+	released[release_count++] = *(int *) object;
+}
+
+void
+test_rf_arena_alloc() {
+	rf_Arena *arena = rf_arena_new();
+	CU_ASSERT_EQUAL(rf_arena_size(arena), 0);
+
+	char *a = rf_arena_alloc(arena, 1);
+	char *b = rf_arena_alloc(arena, 24);
+	char *big = rf_arena_alloc(arena, 100000);
+	char *c = rf_arena_alloc(arena, 8);
+	CU_ASSERT_EQUAL((uintptr_t) a % 16, 0);
+	CU_ASSERT_EQUAL((uintptr_t) b % 16, 0);
+	CU_ASSERT_EQUAL((uintptr_t) big % 16, 0);
+	CU_ASSERT_TRUE(b >= a + 16);
+	//a large block does not end the chunk in use
+	CU_ASSERT_TRUE(c >= b + 32 && c < b + 64);
+	big[99999] = 1;
+	CU_ASSERT_TRUE(rf_arena_size(arena) >= 100000);
+
+	//deferred releases run in reverse order
+	int values[] = { 1, 2, 3 };
+	release_count = 0;
+	for(int i = 0; i < 3; i++)
+		rf_arena_defer(arena, record_release, &values[i]);
+	rf_arena_clear(arena);
+	CU_ASSERT_EQUAL(release_count, 3);
+	CU_ASSERT_EQUAL(released[0], 3);
+	CU_ASSERT_EQUAL(released[2], 1);
+	CU_ASSERT_EQUAL(rf_arena_size(arena), 0);
+
+	//usable after clearing, released ones stay released
+	CU_ASSERT_PTR_NOT_EQUAL(rf_arena_alloc(arena, 8), NULL);
+	rf_arena_free(arena);
+	CU_ASSERT_EQUAL(release_count, 3);
+}
+
+void
+test_rf_arena_set() {
+	const size_t count = rf_atom_count();
+	rf_Arena *arena = rf_arena_new();
+
+	char a[] = "arena a";
+	char b[] = "arena b";
+	char c[] = "arena c";
+	rf_Set *base = rf_set_new_in(arena, 3, (rf_SetElement *[]) {
+		rf_set_element_new_string_in(arena, a),
+		rf_set_element_new_string_in(arena, b),
+		rf_set_element_new_string(c),	// taken over from outside the arena
+	});
+	CU_ASSERT_TRUE(base->in_arena);
+	CU_ASSERT_TRUE(base->elements[0]->in_arena);
+	CU_ASSERT_FALSE(base->elements[2]->in_arena);
+
+	rf_Set *powerset = rf_set_new_powerset_in(arena, base);
+	rf_Set *expected = rf_set_new_powerset(base);
+	CU_ASSERT_EQUAL(powerset->cardinality, 8);
+	CU_ASSERT_TRUE(powerset->elements[5]->in_arena);
+	CU_ASSERT_TRUE(powerset->elements[5]->value.set->elements[0]->in_arena);
+	CU_ASSERT_FALSE(expected->in_arena);
+	CU_ASSERT_TRUE(rf_set_equal(powerset, expected));
+	CU_ASSERT_TRUE(rf_set_contains_element(powerset, expected->elements[3]));
+
+	//copies out of the arena outlive it
+	rf_Set *kept = rf_set_clone(powerset);
+	rf_SetElement *element = rf_set_element_clone_in(arena, expected->elements[7]);
+	CU_ASSERT_TRUE(element->in_arena);
+	CU_ASSERT_PTR_EQUAL(element->key, expected->elements[7]->key);
+
+	//freeing objects of the arena does nothing
+	rf_set_free(powerset);
+	rf_set_element_free(element);
+	CU_ASSERT_TRUE(rf_set_equal(base, expected->elements[7]->value.set));
+
+	rf_arena_free(arena);
+	CU_ASSERT_TRUE(rf_set_equal(kept, expected));
+	rf_set_free(kept);
+	rf_set_free(expected);
+	CU_ASSERT_EQUAL(rf_atom_count(), count);
+}
+
+void
+test_rf_arena_relation() {
+	rf_Arena *arena = rf_arena_new();
+
+	char a[] = "a";
+	char b[] = "b";
+	rf_Set *d = rf_set_new(2, (rf_SetElement *[]) {
+		rf_set_element_new_string(a),
+		rf_set_element_new_string(b),
+	});
+
+	rf_Relation *id = rf_relation_new_id_in(arena, d);
+	rf_Relation *top = rf_relation_new_top_in(arena, d);
+	rf_Relation *full = rf_relation_new_full_in(arena, d, d);
+	CU_ASSERT_TRUE(id->in_arena);
+	CU_ASSERT_TRUE(id->domains[0]->in_arena);
+	CU_ASSERT_TRUE(rf_relation_is_equivalent(id));
+	CU_ASSERT_TRUE(rf_relation_is_partial_order(top));
+	CU_ASSERT_TRUE(rf_relation_get(full, 1, 0));
+
+	rf_Relation *clone = rf_relation_clone_in(arena, top);
+	rf_Relation *converse = rf_relation_new_converse(clone, NULL);
+	CU_ASSERT_TRUE(rf_relation_get(clone, 0, 1));
+	CU_ASSERT_TRUE(rf_relation_get(converse, 1, 0));
+	CU_ASSERT_FALSE(converse->in_arena);
+
+	rf_relation_free(clone);
+	CU_ASSERT_TRUE(rf_relation_get(clone, 0, 1));
+
+	rf_arena_free(arena);
+	CU_ASSERT_TRUE(rf_relation_is_antisymmetric(converse));
+	rf_relation_free(converse);
+	rf_set_free(d);
+}
+
+
+CU_ErrorCode
+register_suites_arena() {
+	CU_TestInfo arena_suite[] = {
+		{ "rf_arena_alloc", test_rf_arena_alloc },
+		{ "rf_arena_set", test_rf_arena_set },
+		{ "rf_arena_relation", test_rf_arena_relation },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Arena", NULL, NULL, arena_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
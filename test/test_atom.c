@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <CUnit/CUnit.h>
+
+#include "atom.h"
+#include "set.h"
+
+void
+test_rf_atom_intern() {
+	const size_t count = rf_atom_count();
+
+	char buf[] = "atom";
+	const char *a = rf_atom_intern(buf);
+	const char *b = rf_atom_intern("atom");
+	const char *c = rf_atom_intern("other atom");
+
+	//equal strings share one atom, not the caller's storage
+	CU_ASSERT_PTR_EQUAL(a, b);
+	CU_ASSERT_PTR_NOT_EQUAL(a, buf);
+	CU_ASSERT_PTR_NOT_EQUAL(a, c);
+	CU_ASSERT_STRING_EQUAL(a, "atom");
+	CU_ASSERT_EQUAL(rf_atom_id(a), rf_atom_id(b));
+	CU_ASSERT_NOT_EQUAL(rf_atom_id(a), rf_atom_id(c));
+	CU_ASSERT_EQUAL(rf_atom_count(), count + 2);
+
+	//alive while a reference is left
+	CU_ASSERT_PTR_EQUAL(rf_atom_acquire(a), a);
+	rf_atom_release(a);
+	rf_atom_release(b);
+	CU_ASSERT_EQUAL(rf_atom_count(), count + 2);
+	rf_atom_release(a);
+	rf_atom_release(c);
+	CU_ASSERT_EQUAL(rf_atom_count(), count);
+}
+
+void
+test_rf_atom_set_element() {
+	const size_t count = rf_atom_count();
+
+	char name[] = "shared";
+	rf_SetElement *e = rf_set_element_new_string(name);
+	rf_SetElement *f = rf_set_element_new_string(name);
+	rf_SetElement *g = rf_set_element_clone(e);
+
+	CU_ASSERT_PTR_EQUAL(e->value.string, f->value.string);
+	CU_ASSERT_PTR_EQUAL(e->value.string, g->value.string);
+	CU_ASSERT_TRUE(rf_set_element_equal(f, g));
+	CU_ASSERT_EQUAL(rf_atom_count(), count + 1);
+
+	rf_set_element_free(e);
+	rf_set_element_free(f);
+	CU_ASSERT_STRING_EQUAL(g->value.string, name);
+	rf_set_element_free(g);
+	CU_ASSERT_EQUAL(rf_atom_count(), count);
+}
+
+#define THREADS 4
+#define NAMES 2000
+
+static void *
+intern_names(void *arg) {
+	const char **atoms = arg;
+	char buf[16];
+
+	for(int round = 0; round < 20; round++) {
+		for(int i = 0; i < NAMES; i++) {
+			snprintf(buf, sizeof(buf), "n%d", i);
+			atoms[i] = rf_atom_intern(buf);
+		}
+		for(int i = 0; i < NAMES; i++)
+			rf_atom_release(atoms[i]);
+	}
+	for(int i = 0; i < NAMES; i++) {
+		snprintf(buf, sizeof(buf), "n%d", i);
+		atoms[i] = rf_atom_intern(buf);
+	}
+
+	return NULL;
+}
+
+void
+test_rf_atom_threads() {
+	const size_t count = rf_atom_count();
+	static const char *atoms[THREADS][NAMES];
+	pthread_t threads[THREADS];
+
+	for(int t = 0; t < THREADS; t++)
+		pthread_create(&threads[t], NULL, intern_names, atoms[t]);
+	for(int t = 0; t < THREADS; t++)
+		pthread_join(threads[t], NULL);
+
+	//all threads agree on every atom
+	CU_ASSERT_EQUAL(rf_atom_count(), count + NAMES);
+	for(int i = 0; i < NAMES; i++) {
+		for(int t = 1; t < THREADS; t++)
+			CU_ASSERT_PTR_EQUAL(atoms[t][i], atoms[0][i]);
+	}
+
+	for(int t = 0; t < THREADS; t++) {
+		for(int i = 0; i < NAMES; i++)
+			rf_atom_release(atoms[t][i]);
+	}
+	CU_ASSERT_EQUAL(rf_atom_count(), count);
+}
+
+
+CU_ErrorCode
+register_suites_atom() {
+	CU_TestInfo atom_suite[] = {
+		{ "rf_atom_intern", test_rf_atom_intern },
+		{ "rf_atom_set_element", test_rf_atom_set_element },
+		{ "rf_atom_threads", test_rf_atom_threads },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Atom", NULL, NULL, atom_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <CUnit/CUnit.h>
+
+#include "closure.h"
+#include "test_fixtures.h"
+
+static bool
+equals_closure_of(const rf_Relation *closed, const rf_Relation *r) {
+	rf_Relation *expected = rf_relation_clone(r);
+	rf_relation_make_transitive(expected, true, NULL);
+
+	bool equal = true;
+	const int dim = r->domains[0]->cardinality;
+	for(int x = 0; x < dim; x++) {
+		for(int y = 0; y < dim; y++) {
+			if(rf_relation_get(closed, x, y) != rf_relation_get(expected, x, y))
+				equal = false;
+		}
+	}
+
+	rf_relation_free(expected);
+	return equal;
+}
+
+void
+test_rf_closure_insert() {
+	int n = 100;
+	rf_Set *set = generateNumberedSet(n);
+	rf_Relation *r = rf_relation_new_empty(set, set);
+	rf_relation_set(r, 1, 2, true);
+	rf_relation_set(r, 70, 1, true);
+
+	rf_Closure *closure = rf_closure_new(r, NULL);
+	CU_ASSERT_PTR_NOT_NULL(closure);
+	CU_ASSERT_TRUE(rf_closure_get(closure, 70, 2));
+
+	int pairs[][2] = { { 2, 3 }, { 3, 80 }, { 80, 70 }, { 5, 5 }, { 99, 0 }, { 0, 99 } };
+	for(int i = 0; i < 6; i++) {
+		CU_ASSERT_TRUE(rf_closure_insert(closure, pairs[i][0], pairs[i][1]));
+		rf_relation_set(r, pairs[i][0], pairs[i][1], true);
+		CU_ASSERT_TRUE(equals_closure_of(rf_closure_get_relation(closure), r));
+	}
+
+	//already there
+	CU_ASSERT_FALSE(rf_closure_insert(closure, 1, 80));
+	CU_ASSERT_TRUE(rf_closure_get(closure, 80, 80));
+
+	rf_closure_free(closure);
+	rf_relation_free(r);
+	rf_set_free(set);
+}
+
+void
+test_rf_closure_defer() {
+	int n = 150;
+	rf_Set *set = generateNumberedSet(n);
+	rf_Relation *r = rf_relation_new_empty(set, set);
+	for(int x = 0; x < n; x += 3)
+		rf_relation_set(r, x, (x * 7 + 1) % n, true);
+
+	rf_Closure *closure = rf_closure_new(r, NULL);
+	for(int i = 0; i < 40; i++) {
+		int x = (i * 37) % n, y = (i * 53 + 11) % n;
+		CU_ASSERT_TRUE(rf_closure_defer(closure, x, y, NULL));
+		rf_relation_set(r, x, y, true);
+	}
+	CU_ASSERT_EQUAL(closure->n_pending, 40);
+
+	rf_closure_flush(closure);
+	CU_ASSERT_EQUAL(closure->n_pending, 0);
+	CU_ASSERT_TRUE(equals_closure_of(rf_closure_get_relation(closure), r));
+
+	//heterogeneous relations have no closure
+	rf_Set *other = generateNumberedSet(3);
+	rf_Relation *hetero = rf_relation_new_empty(set, other);
+	rf_Error error;
+	CU_ASSERT_PTR_NULL(rf_closure_new(hetero, &error));
+
+	rf_relation_free(hetero);
+	rf_set_free(other);
+	rf_closure_free(closure);
+	rf_relation_free(r);
+	rf_set_free(set);
+}
+
+
+CU_ErrorCode
+register_suites_closure() {
+	CU_TestInfo closure_suite[] = {
+		{ "rf_closure_insert", test_rf_closure_insert },
+		{ "rf_closure_defer", test_rf_closure_defer },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Closure", NULL, NULL, closure_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Fixtures shared by the test suites, defined in test_relation.c.
+ */
+
+#ifndef RF_TEST_FIXTURES_H
+#define RF_TEST_FIXTURES_H
+
+#include "set.h"
+#include "relation.h"
+
+void            generateTestElements(int n, rf_SetElement *elements[n]);
+void            generateNumberedElements(int n, rf_SetElement *elements[n]);
+rf_Set *        generateNumberedSet(int n);
+rf_Relation *   generateOrder(rf_Set *set, int count, const int pairs[][2]);
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <CUnit/CUnit.h>
+
+#include "index_set.h"
+#include "test_fixtures.h"
+
+void
+test_rf_index_set_next() {
+	//members across word boundaries, iterated in order
+	rf_IndexSet *s = rf_index_set_new(200);
+	const int members[] = { 0, 63, 64, 130, 199 };
+	for(int i = 0; i < 5; i++)
+		rf_index_set_add(s, members[i]);
+
+	CU_ASSERT_EQUAL(rf_index_set_count(s), 5);
+	int count = 0;
+	for(int i = rf_index_set_next(s, 0); i >= 0; i = rf_index_set_next(s, i + 1)) {
+		CU_ASSERT_EQUAL(i, members[count]);
+		count++;
+	}
+	CU_ASSERT_EQUAL(count, 5);
+	CU_ASSERT_EQUAL(rf_index_set_next(s, 65), 130);
+	CU_ASSERT_EQUAL(rf_index_set_next(s, 200), -1);
+
+	rf_index_set_remove(s, 130);
+	CU_ASSERT_FALSE(rf_index_set_contains(s, 130));
+	CU_ASSERT_EQUAL(rf_index_set_next(s, 65), 199);
+
+	rf_IndexSet *full = rf_index_set_new_full(70);
+	CU_ASSERT_EQUAL(rf_index_set_count(full), 70);
+	CU_ASSERT_EQUAL(rf_index_set_next(full, 69), 69);
+	rf_IndexSet *clone = rf_index_set_clone(full);
+	CU_ASSERT_EQUAL(rf_index_set_count(clone), 70);
+
+	rf_index_set_free(clone);
+	rf_index_set_free(full);
+	rf_index_set_free(s);
+}
+
+void
+test_rf_index_set_from_set() {
+	rf_Set *domain = generateNumberedSet(4);
+
+	rf_SetElement *members[] = { rf_set_element_new_string("e3"), rf_set_element_new_string("e1") };
+	rf_Set *subset = rf_set_new(2, members);
+
+	rf_IndexSet *s = rf_index_set_new_from_set(subset, domain, NULL);
+	CU_ASSERT_PTR_NOT_NULL(s);
+	CU_ASSERT_EQUAL(rf_index_set_count(s), 2);
+	CU_ASSERT_TRUE(rf_index_set_contains(s, 1));
+	CU_ASSERT_TRUE(rf_index_set_contains(s, 3));
+
+	//back in the order of the domain
+	rf_Set *set = rf_index_set_to_set(s, domain);
+	CU_ASSERT_EQUAL(set->cardinality, 2);
+	CU_ASSERT_TRUE(rf_set_element_equal(set->elements[0], domain->elements[1]));
+	CU_ASSERT_TRUE(rf_set_element_equal(set->elements[1], domain->elements[3]));
+	rf_set_free(set);
+	rf_index_set_free(s);
+
+	//members have to be in the domain
+	rf_Error error;
+	rf_SetElement *strangers[] = { rf_set_element_new_string("x") };
+	rf_Set *other = rf_set_new(1, strangers);
+	CU_ASSERT_PTR_NULL(rf_index_set_new_from_set(other, domain, &error));
+	CU_ASSERT_EQUAL(error.code, RF_E_SET_NOT_SUBSET);
+
+	rf_set_free(other);
+	rf_set_free(subset);
+	rf_set_free(domain);
+}
+
+
+CU_ErrorCode
+register_suites_index_set() {
+	CU_TestInfo index_set_suite[] = {
+		{ "rf_index_set_next", test_rf_index_set_next },
+		{ "rf_index_set_from_set", test_rf_index_set_from_set },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "IndexSet", NULL, NULL, index_set_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
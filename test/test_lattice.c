@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <CUnit/CUnit.h>
+
+#include "lattice.h"
+#include "test_fixtures.h"
+
+void
+test_rf_lattice_join_meet() {
+	//the diamond: 3 above 1 and 2, both above 0
+	rf_Set *set = generateNumberedSet(4);
+	const int pairs[][2] = { { 3, 1 }, { 3, 2 }, { 1, 0 }, { 2, 0 } };
+	rf_Relation *diamond = generateOrder(set, 4, pairs);
+
+	rf_Lattice *l = rf_lattice_new(diamond, NULL);
+	CU_ASSERT_PTR_NOT_NULL(l);
+	CU_ASSERT_PTR_NOT_NULL(l->join);
+	CU_ASSERT_EQUAL(l->bottom, 0);
+	CU_ASSERT_EQUAL(l->top, 3);
+	CU_ASSERT_EQUAL(rf_lattice_join(l, 1, 2), 3);
+	CU_ASSERT_EQUAL(rf_lattice_join(l, 2, 1), 3);
+	CU_ASSERT_EQUAL(rf_lattice_meet(l, 1, 2), 0);
+	CU_ASSERT_EQUAL(rf_lattice_join(l, 0, 2), 2);
+	CU_ASSERT_EQUAL(rf_lattice_meet(l, 3, 1), 1);
+	CU_ASSERT_EQUAL(rf_lattice_meet(l, 2, 2), 2);
+
+	const int lower[] = { 0, 1 };
+	const int middle[] = { 1, 0, 2 };
+	CU_ASSERT_EQUAL(rf_lattice_join_all(l, 2, lower), 1);
+	CU_ASSERT_EQUAL(rf_lattice_join_all(l, 3, middle), 3);
+	CU_ASSERT_EQUAL(rf_lattice_meet_all(l, 3, middle), 0);
+	CU_ASSERT_EQUAL(rf_lattice_meet_all(l, 1, middle), 1);
+
+	//the empty join is the least element, the empty meet the greatest
+	CU_ASSERT_EQUAL(rf_lattice_join_all(l, 0, NULL), 0);
+	CU_ASSERT_EQUAL(rf_lattice_meet_all(l, 0, NULL), 3);
+
+	rf_lattice_free(l);
+	rf_relation_free(diamond);
+	rf_set_free(set);
+}
+
+void
+test_rf_lattice_new() {
+	//2 and 3 both above 0 and 1: neither pair has a least upper bound
+	rf_Set *set = generateNumberedSet(4);
+	const int pairs[][2] = { { 2, 0 }, { 2, 1 }, { 3, 0 }, { 3, 1 } };
+	rf_Relation *r = generateOrder(set, 4, pairs);
+
+	rf_Error error;
+	CU_ASSERT_PTR_NULL(rf_lattice_new(r, &error));
+	CU_ASSERT_EQUAL(error.code, RF_E_REL_NOT_LATTICE);
+
+	//orders only
+	rf_relation_set(r, 0, 2, true);
+	CU_ASSERT_PTR_NULL(rf_lattice_new(r, &error));
+	CU_ASSERT_EQUAL(error.code, RF_E_REL_NOT_ORDERED);
+	rf_relation_free(r);
+
+	//the empty lattice has neither top nor bottom
+	rf_Set *empty = generateNumberedSet(0);
+	r = rf_relation_new_id(empty);
+	rf_Lattice *l = rf_lattice_new(r, NULL);
+	CU_ASSERT_PTR_NOT_NULL(l);
+	CU_ASSERT_EQUAL(rf_lattice_join_all(l, 0, NULL), -1);
+	rf_lattice_free(l);
+	rf_relation_free(r);
+	rf_set_free(empty);
+
+	rf_set_free(set);
+}
+
+
+CU_ErrorCode
+register_suites_lattice() {
+	CU_TestInfo lattice_suite[] = {
+		{ "rf_lattice_join_meet", test_rf_lattice_join_meet },
+		{ "rf_lattice_new", test_rf_lattice_new },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Lattice", NULL, NULL, lattice_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
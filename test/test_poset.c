@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <CUnit/CUnit.h>
+
+#include "poset.h"
+#include "test_fixtures.h"
+
+void
+test_rf_poset_join_meet() {
+	//the diamond: 3 above 1 and 2, both above 0
+	rf_Set *set = generateNumberedSet(4);
+	const int pairs[][2] = { { 3, 1 }, { 3, 2 }, { 1, 0 }, { 2, 0 } };
+	rf_Relation *diamond = generateOrder(set, 4, pairs);
+
+	rf_Poset *p = rf_poset_new(diamond, NULL);
+	CU_ASSERT_PTR_NOT_NULL(p);
+	CU_ASSERT_EQUAL(rf_poset_join(p, 1, 2), 3);
+	CU_ASSERT_EQUAL(rf_poset_meet(p, 1, 2), 0);
+	CU_ASSERT_EQUAL(rf_poset_join(p, 0, 2), 2);
+	CU_ASSERT_EQUAL(rf_poset_meet(p, 3, 1), 1);
+	CU_ASSERT_EQUAL(rf_poset_join(p, 2, 2), 2);
+
+	//the linear extension puts smaller elements first
+	CU_ASSERT_EQUAL(p->order[0], 0);
+	CU_ASSERT_EQUAL(p->order[3], 3);
+	CU_ASSERT_TRUE(rf_poset_is_lattice(p, NULL));
+
+	rf_poset_free(p);
+	rf_relation_free(diamond);
+	rf_set_free(set);
+}
+
+void
+test_rf_poset_is_lattice() {
+	//2 and 3 both above 0 and 1: neither pair has a least upper bound
+	rf_Set *set = generateNumberedSet(4);
+	const int pairs[][2] = { { 2, 0 }, { 2, 1 }, { 3, 0 }, { 3, 1 } };
+	rf_Relation *r = generateOrder(set, 4, pairs);
+
+	rf_Poset *p = rf_poset_new(r, NULL);
+	CU_ASSERT_EQUAL(rf_poset_join(p, 0, 1), -1);
+	CU_ASSERT_EQUAL(rf_poset_meet(p, 0, 1), -1);
+	CU_ASSERT_EQUAL(rf_poset_meet(p, 2, 3), -1);
+
+	int pair[2];
+	CU_ASSERT_FALSE(rf_poset_is_lattice(p, pair));
+	CU_ASSERT_EQUAL(pair[0], 0);
+	CU_ASSERT_EQUAL(pair[1], 1);
+	rf_poset_free(p);
+
+	//orders only
+	rf_Error error;
+	rf_relation_set(r, 0, 2, true);
+	CU_ASSERT_PTR_NULL(rf_poset_new(r, &error));
+	CU_ASSERT_EQUAL(error.code, RF_E_REL_NOT_ORDERED);
+
+	rf_relation_free(r);
+	rf_set_free(set);
+}
+
+
+CU_ErrorCode
+register_suites_poset() {
+	CU_TestInfo poset_suite[] = {
+		{ "rf_poset_join_meet", test_rf_poset_join_meet },
+		{ "rf_poset_is_lattice", test_rf_poset_is_lattice },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Poset", NULL, NULL, poset_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
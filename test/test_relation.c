@@ -18,14 +18,20 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
 
 #include <CUnit/CUnit.h>
 
 #include "error.h"
 #include "set.h"
 #include "relation.h"
+#include "test_fixtures.h"
 
-extern size_t rf_table_idx(rf_Relation *, int, int);
+/* Cell i of the relation, counted row by row without padding. */
+static bool
+table_at(const rf_Relation *r, int i) {
+	return rf_relation_get(r, i / r->domains[1]->cardinality, i % r->domains[1]->cardinality);
+}
 
 char a[] = "a";
 char b[] = "b";
@@ -46,6 +52,36 @@ void generateTestElements(int n, rf_SetElement *elements[n]){
 	}
 }
 
+/* Elements named e0, e1, ... */
+void generateNumberedElements(int n, rf_SetElement *elements[n]){
+	char buf[16];
+	for(int i = 0; i < n; i++) {
+		snprintf(buf, sizeof(buf), "e%d", i);
+		elements[i] = rf_set_element_new_string(buf);
+	}
+}
+
+rf_Set *generateNumberedSet(int n){
+	rf_SetElement **elements = malloc((n > 0 ? n : 1) * sizeof(*elements));
+	generateNumberedElements(n, elements);
+
+	rf_Set *s = rf_set_new(n, elements);
+	free(elements);
+	return s;
+}
+
+/*
+ * xRy for x above y, the pairs given as x, y and closed reflexively and transitively.
+ */
+rf_Relation *generateOrder(rf_Set *set, int count, const int pairs[][2]){
+	rf_Relation *r = rf_relation_new_id(set);
+	for(int i = 0; i < count; i++)
+		rf_relation_set(r, pairs[i][0], pairs[i][1], true);
+	rf_relation_make_transitive(r, true, NULL);
+
+	return r;
+}
+
 int init_suite(void) {
 	rf_SetElement *elems[3];
 	rf_SetElement *elems2[1];
@@ -83,12 +119,14 @@ void test_rf_relation_new_empty(){
 
 	CU_ASSERT_PTR_NOT_NULL(empty_relation);
 
-	CU_ASSERT_PTR_EQUAL(set, empty_relation->domains[0]);
-	CU_ASSERT_PTR_EQUAL(set, empty_relation->domains[1]);
+	CU_ASSERT_PTR_NOT_EQUAL(set, empty_relation->domains[0]);
+	CU_ASSERT_TRUE(rf_set_equal(set, empty_relation->domains[0]));
+	CU_ASSERT_PTR_NOT_EQUAL(set, empty_relation->domains[1]);
+	CU_ASSERT_TRUE(rf_set_equal(set, empty_relation->domains[1]));
 
 	int n = (set->cardinality) * (set->cardinality);
 	for(int i = 0; i < n; i++){
-		CU_ASSERT_FALSE(empty_relation->table[i]);
+		CU_ASSERT_FALSE(table_at(empty_relation, i));
 	}
 }
 
@@ -97,12 +135,14 @@ void test_rf_relation_new_full(){
 
 	CU_ASSERT_PTR_NOT_NULL(full_relation);
 
-	CU_ASSERT_PTR_EQUAL(set, full_relation->domains[0]);
-	CU_ASSERT_PTR_EQUAL(set, full_relation->domains[1]);
+	CU_ASSERT_PTR_NOT_EQUAL(set, full_relation->domains[0]);
+	CU_ASSERT_TRUE(rf_set_equal(set, full_relation->domains[0]));
+	CU_ASSERT_PTR_NOT_EQUAL(set, full_relation->domains[1]);
+	CU_ASSERT_TRUE(rf_set_equal(set, full_relation->domains[1]));
 
 	int n = (set->cardinality) * (set->cardinality);
 	for(int i = 0; i < n; i++){
-		CU_ASSERT_TRUE(full_relation->table[i]);
+		CU_ASSERT_TRUE(table_at(full_relation, i));
 	}
 }
 
@@ -115,14 +155,16 @@ void test_rf_relation_new(){
 	rf_Relation *relation = rf_relation_new(set, set, table);
 	CU_ASSERT_PTR_NOT_NULL(relation);
 
-	CU_ASSERT_PTR_EQUAL(set, relation->domains[0]);
-	CU_ASSERT_PTR_EQUAL(set, relation->domains[1]);
+	CU_ASSERT_PTR_NOT_EQUAL(set, relation->domains[0]);
+	CU_ASSERT_TRUE(rf_set_equal(set, relation->domains[0]));
+	CU_ASSERT_PTR_NOT_EQUAL(set, relation->domains[1]);
+	CU_ASSERT_TRUE(rf_set_equal(set, relation->domains[1]));
 
 	for(int i = 0; i < n; i++){
 		if(i % (set->cardinality+1) == 0){
-			CU_ASSERT_TRUE(relation->table[i]);
+			CU_ASSERT_TRUE(table_at(relation, i));
 		} else {
-			CU_ASSERT_FALSE(relation->table[i]);
+			CU_ASSERT_FALSE(table_at(relation, i));
 		}
 	}
 }
@@ -145,9 +187,9 @@ void test_rf_relation_clone(){
 
 	for(int i = 0; i < n; i++){
 		if(i % (set->cardinality+1) == 0){
-			CU_ASSERT_TRUE(result->table[i]);
+			CU_ASSERT_TRUE(table_at(result, i));
 		} else {
-			CU_ASSERT_FALSE(result->table[i]);
+			CU_ASSERT_FALSE(table_at(result, i));
 		}
 	}
 }
@@ -156,60 +198,94 @@ void test_rf_relation_new_id(){
 	rf_Relation * relation = rf_relation_new_id(set);
 	CU_ASSERT_PTR_NOT_NULL(relation);
 
-	CU_ASSERT_PTR_EQUAL(relation->domains[0], set);
-	CU_ASSERT_PTR_EQUAL(relation->domains[1], set);
+	CU_ASSERT_PTR_NOT_EQUAL(relation->domains[0], set);
+	CU_ASSERT_TRUE(rf_set_equal(relation->domains[0], set));
+	CU_ASSERT_PTR_NOT_EQUAL(relation->domains[1], set);
+	CU_ASSERT_TRUE(rf_set_equal(relation->domains[1], set));
 
 	int n = set->cardinality * set->cardinality;
 	for(int i = 0; i < n; i++){
 		if(i % (set->cardinality+1) == 0){
-			CU_ASSERT_TRUE(relation->table[i]);
+			CU_ASSERT_TRUE(table_at(relation, i));
 		} else {
-			CU_ASSERT_FALSE(relation->table[i]);
+			CU_ASSERT_FALSE(table_at(relation, i));
+		}
+	}
+}
+
+void test_rf_relation_new_wide(){
+	int n = 70;
+	rf_SetElement *elems[n];
+	generateTestElements(n, elems);
+	rf_Set *wide = rf_set_new(n, elems);
+
+	rf_Relation *relation = rf_relation_new_full(set, wide);
+	for(int x = 0; x < set->cardinality; x++){
+		for(int y = 0; y < n; y++){
+			CU_ASSERT_TRUE(rf_relation_get(relation, x, y));
 		}
 	}
+
+	rf_relation_set(relation, 1, 63, false);
+	rf_relation_set(relation, 2, 64, false);
+	rf_Relation *clone = rf_relation_clone(relation);
+	CU_ASSERT_FALSE(rf_relation_get(clone, 1, 63));
+	CU_ASSERT_TRUE(rf_relation_get(clone, 1, 64));
+	CU_ASSERT_TRUE(rf_relation_get(clone, 2, 63));
+	CU_ASSERT_FALSE(rf_relation_get(clone, 2, 64));
+
+	rf_relation_free(clone);
+	rf_relation_free(relation);
+	rf_set_free(wide);
 }
 
-void test_rf_table_idx(){
-	rf_Relation *relation = rf_relation_new_full(set, set);
+void test_rf_relation_row(){
+	rf_Relation *relation = rf_relation_new_id(set);
 
+	CU_ASSERT_EQUAL(relation->stride, rf_bitrow_words(set->cardinality));
 	for(int x=0;x<set->cardinality;x++){
+		const uint64_t *row = rf_relation_row_const(relation, x);
+		CU_ASSERT_PTR_EQUAL(row, relation->table + x * relation->stride);
+		CU_ASSERT_EQUAL((uintptr_t) row % (RF_BITROW_LINE_WORDS * sizeof(uint64_t)), 0);
 		for(int y=0;y<set->cardinality;y++){
-			CU_ASSERT_EQUAL(rf_table_idx(relation, x,y), (x*set->cardinality)+y);
+			CU_ASSERT_EQUAL(rf_bitrow_get(row, y), x == y);
 		}
 	}
+
+	rf_relation_free(relation);
 }
 
 void test_rf_relation_new_top(){
 	rf_Relation *relation = rf_relation_new_top(set);
 
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 0, 0)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 0, 1)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 0, 2)]);
+	CU_ASSERT_TRUE(rf_relation_get(relation, 0, 0));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 0, 1));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 0, 2));
 
-	CU_ASSERT_FALSE(relation->table[rf_table_idx(relation, 1, 0)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 1, 1)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 1, 2)]);
+	CU_ASSERT_FALSE(rf_relation_get(relation, 1, 0));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 1, 1));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 1, 2));
 
-	CU_ASSERT_FALSE(relation->table[rf_table_idx(relation, 2, 0)]);
-	CU_ASSERT_FALSE(relation->table[rf_table_idx(relation, 2, 1)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 2, 2)]);
+	CU_ASSERT_FALSE(rf_relation_get(relation, 2, 0));
+	CU_ASSERT_FALSE(rf_relation_get(relation, 2, 1));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 2, 2));
 
 }
 
 void test_rf_relation_new_bottom(){
 	rf_Relation *relation = rf_relation_new_bottom(set);
 
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 0, 0)]);
-	CU_ASSERT_FALSE(relation->table[rf_table_idx(relation, 0, 1)]);
-	CU_ASSERT_FALSE(relation->table[rf_table_idx(relation, 0, 2)]);
+	CU_ASSERT_TRUE(rf_relation_get(relation, 0, 0));
+	CU_ASSERT_FALSE(rf_relation_get(relation, 0, 1));
+	CU_ASSERT_FALSE(rf_relation_get(relation, 0, 2));
 
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 1, 0)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 1, 1)]);
-	CU_ASSERT_FALSE(relation->table[rf_table_idx(relation, 1, 2)]);
+	CU_ASSERT_TRUE(rf_relation_get(relation, 1, 0));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 1, 1));
+	CU_ASSERT_FALSE(rf_relation_get(relation, 1, 2));
 
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 2, 0)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 2, 1)]);
-	CU_ASSERT_TRUE(relation->table[rf_table_idx(relation, 2, 2)]);
+	CU_ASSERT_TRUE(rf_relation_get(relation, 2, 0));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 2, 1));
+	CU_ASSERT_TRUE(rf_relation_get(relation, 2, 2));
 
 }
 
@@ -228,20 +304,20 @@ void test_rf_relation_new_union(){
 	result = rf_relation_new_union(idR, r1, &error);
 	int n = set->cardinality * set->cardinality;
 	for(int i=0;i<n;i++){
-		CU_ASSERT_EQUAL(idR->table[i], result->table[i]);
+		CU_ASSERT_EQUAL(table_at(idR, i), table_at(result, i));
 	}
 
 	//Union id-Relation with itself
 	result = rf_relation_new_union(idR, idR, &error);
 	for(int i=0;i<n;i++){
-		CU_ASSERT_EQUAL(idR->table[i], result->table[i]);
+		CU_ASSERT_EQUAL(table_at(idR, i), table_at(result, i));
 	}
 
 	//Union between id-R and its complement
 	result = rf_relation_new_union(idR, rf_relation_new_complement(idR, &error), &error);
 
 	for(int i=0;i<n;i++){
-		CU_ASSERT_TRUE(result->table[i]);
+		CU_ASSERT_TRUE(table_at(result, i));
 	}
 
 	//Union between two relations that have different domains
@@ -255,7 +331,7 @@ void test_rf_relation_new_intersection(){
 	rf_Relation *idR = rf_relation_new_id(set);
 	rf_Relation *r1 = rf_relation_new_empty(set, set);
 	rf_Relation *r2 = rf_relation_new_empty(set, set);
-	r2->table[rf_table_idx(r1,1,1)] = true;
+	rf_relation_set(r2, 1, 1, true);
 	rf_Relation *result;
 
 	rf_Relation *idRSet2 = rf_relation_new_id(set2);
@@ -264,22 +340,22 @@ void test_rf_relation_new_intersection(){
 	result = rf_relation_new_intersection(idR, r1, &error);
 	int n = set->cardinality * set->cardinality;
 	for(int i=0;i<n;i++){
-		CU_ASSERT_FALSE(result->table[i]);
+		CU_ASSERT_FALSE(table_at(result, i));
 	}
 
 	//Intersection id-Relation with itself
 	result = rf_relation_new_intersection(idR, idR, &error);
 	for(int i=0;i<n;i++){
-		CU_ASSERT_EQUAL(idR->table[i], result->table[i]);
+		CU_ASSERT_EQUAL(table_at(idR, i), table_at(result, i));
 	}
 
 	//Intersection id-Relation with a relation having one intersection element
 	result = rf_relation_new_intersection(idR, r2, &error);
 	for(int i=0;i<n;i++){
-		if(i == rf_table_idx(result, 1,1)){
-			CU_ASSERT_TRUE(result->table[i])
+		if(i == 1 * set->cardinality + 1){
+			CU_ASSERT_TRUE(table_at(result, i))
 		} else{
-			CU_ASSERT_FALSE(result->table[i]);
+			CU_ASSERT_FALSE(table_at(result, i));
 		}
 	}
 
@@ -297,8 +373,34 @@ void test_rf_relation_new_complement(){
 
 	int n = set->cardinality * set->cardinality;
 	for(int i=0;i<n;i++){
-		CU_ASSERT_NOT_EQUAL(idR->table[i], result->table[i]);
+		CU_ASSERT_NOT_EQUAL(table_at(idR, i), table_at(result, i));
+	}
+}
+
+void test_rf_relation_make_union_intersection_complement(){
+	rf_Relation *r = rf_relation_new_id(set);
+	rf_Relation *top = rf_relation_new_top(set);
+	rf_Relation *idRSet2 = rf_relation_new_id(set2);
+
+	CU_ASSERT_TRUE(rf_relation_make_union(r, top, NULL));
+	for(int x = 0; x < set->cardinality; x++){
+		for(int y = 0; y < set->cardinality; y++){
+			CU_ASSERT_EQUAL(rf_relation_get(r, x, y), rf_relation_get(top, x, y));
+		}
 	}
+
+	CU_ASSERT_TRUE(rf_relation_make_complement(r, NULL));
+	CU_ASSERT_TRUE(rf_relation_make_intersection(r, top, NULL));
+	for(int i = 0; i < set->cardinality * set->cardinality; i++){
+		CU_ASSERT_FALSE(table_at(r, i));
+	}
+
+	CU_ASSERT_FALSE(rf_relation_make_union(r, idRSet2, NULL));
+	CU_ASSERT_FALSE(rf_relation_make_intersection(r, idRSet2, NULL));
+
+	rf_relation_free(r);
+	rf_relation_free(top);
+	rf_relation_free(idRSet2);
 }
 
 void test_rf_relation_new_concatenation(){
@@ -308,8 +410,12 @@ void test_rf_relation_new_concatenation(){
 	rf_Relation *r1 = rf_relation_new_empty(set, set);
 	rf_Relation *r2 = rf_relation_new_empty(set, set);
 
-	r1->table[rf_table_idx(r1,0,1)] = r1->table[rf_table_idx(r1,1,1)] = r1->table[rf_table_idx(r1,2,1)] = true;
-	r2->table[rf_table_idx(r2,1,0)] = r2->table[rf_table_idx(r2,1,1)] = r2->table[rf_table_idx(r2,1,2)] = true;
+	rf_relation_set(r1, 0, 1, true);
+	rf_relation_set(r1, 1, 1, true);
+	rf_relation_set(r1, 2, 1, true);
+	rf_relation_set(r2, 1, 0, true);
+	rf_relation_set(r2, 1, 1, true);
+	rf_relation_set(r2, 1, 2, true);
 
 	rf_Relation *result = rf_relation_new_concatenation(r1, r2, &error);
 
@@ -317,22 +423,83 @@ void test_rf_relation_new_concatenation(){
 	int n = set->cardinality * set->cardinality;
 
 	for(int i=0;i<n;i++){
-	CU_ASSERT_TRUE(result->table[i]);
+	CU_ASSERT_TRUE(table_at(result, i));
 	}
 
-	//TODO: Need more testcases: Other concacts with no full relation result and for heterogeneous relations, too
+	//heterogeneous: set x set2 ; set2 x set
+	rf_Relation *r3 = rf_relation_new_empty(set, set2);
+	rf_Relation *r4 = rf_relation_new_empty(set2, set);
+	rf_relation_set(r3, 1, 0, true);
+	rf_relation_set(r4, 0, 2, true);
+
+	rf_Relation *result2 = rf_relation_new_concatenation(r3, r4, &error);
+	CU_ASSERT_PTR_NOT_NULL(result2);
+	CU_ASSERT_EQUAL(result2->domains[0]->cardinality, set->cardinality);
+	CU_ASSERT_EQUAL(result2->domains[1]->cardinality, set->cardinality);
+	for(int x = 0; x < set->cardinality; x++){
+		for(int z = 0; z < set->cardinality; z++){
+			CU_ASSERT_EQUAL(rf_relation_get(result2, x, z), x == 1 && z == 2);
+		}
+	}
+
+	//domains in the middle differ
+	CU_ASSERT_PTR_NULL(rf_relation_new_concatenation(r3, r3, NULL));
 
 	}
 
 void test_rf_relation_new_converse(){
 	rf_Error error;
 	rf_Relation *r1 = rf_relation_new_empty(set, set);
-	r1->table[rf_table_idx(r1,0,2)] = true;
-	r1->table[rf_table_idx(r1,1,1)] = true;
+	rf_relation_set(r1, 0, 2, true);
+	rf_relation_set(r1, 1, 1, true);
 
 	rf_Relation *result = rf_relation_new_converse(r1, &error);
-	CU_ASSERT_TRUE(result->table[rf_table_idx(result,2,0)]);
-	CU_ASSERT_TRUE(result->table[rf_table_idx(result,1,1)]);
+	CU_ASSERT_TRUE(rf_relation_get(result, 2, 0));
+	CU_ASSERT_TRUE(rf_relation_get(result, 1, 1));
+}
+
+void test_rf_relation_make_converse(){
+	int n = 70;
+	rf_SetElement *elems[n];
+	generateTestElements(n, elems);
+	rf_Set *wide = rf_set_new(n, elems);
+
+	rf_Relation *r1 = rf_relation_new_empty(set, wide);
+	rf_relation_set(r1, 0, 69, true);
+	rf_relation_set(r1, 2, 64, true);
+	rf_relation_set(r1, 1, 0, true);
+
+	//heterogeneous
+	rf_Relation *converse = rf_relation_new_converse(r1, NULL);
+	CU_ASSERT_PTR_NOT_NULL(converse);
+	CU_ASSERT_EQUAL(converse->domains[0]->cardinality, n);
+	CU_ASSERT_EQUAL(converse->domains[1]->cardinality, set->cardinality);
+	for(int x = 0; x < set->cardinality; x++){
+		for(int y = 0; y < n; y++){
+			CU_ASSERT_EQUAL(rf_relation_get(converse, y, x), rf_relation_get(r1, x, y));
+		}
+	}
+
+	CU_ASSERT_TRUE(rf_relation_make_converse(r1, NULL));
+	for(int x = 0; x < n; x++){
+		for(int y = 0; y < set->cardinality; y++){
+			CU_ASSERT_EQUAL(rf_relation_get(r1, x, y), rf_relation_get(converse, x, y));
+		}
+	}
+
+	//square, in place
+	rf_Relation *r2 = rf_relation_new_empty(wide, wide);
+	rf_relation_set(r2, 3, 66, true);
+	rf_relation_set(r2, 65, 65, true);
+	CU_ASSERT_TRUE(rf_relation_make_converse(r2, NULL));
+	CU_ASSERT_TRUE(rf_relation_get(r2, 66, 3));
+	CU_ASSERT_FALSE(rf_relation_get(r2, 3, 66));
+	CU_ASSERT_TRUE(rf_relation_get(r2, 65, 65));
+
+	rf_relation_free(r2);
+	rf_relation_free(converse);
+	rf_relation_free(r1);
+	rf_set_free(wide);
 }
 
 void test_rf_relation_new_subsetleq(){
@@ -341,7 +508,7 @@ void test_rf_relation_new_subsetleq(){
 	rf_Relation *empty = rf_relation_new_subsetleq(set, NULL);
 
 	for(int i=0;i<n;i++){
-		CU_ASSERT_FALSE(empty->table[i]);
+		CU_ASSERT_FALSE(table_at(empty, i));
 	}
 
 	/*
@@ -380,18 +547,17 @@ void test_rf_relation_new_subsetleq(){
 
 	rf_Set *testSet = rf_set_new(3, elemsSet);
 
-	rf_SetElement *tmp = *testSet->elements;
-	CU_ASSERT_TRUE(elemsSet[1]->type == RF_SET_ELEMENT_TYPE_SET);
-	CU_ASSERT_TRUE(tmp[1].type == RF_SET_ELEMENT_TYPE_STRING);
+	CU_ASSERT_TRUE(testSet->elements[0]->type == RF_SET_ELEMENT_TYPE_STRING);
+	CU_ASSERT_TRUE(testSet->elements[1]->type == RF_SET_ELEMENT_TYPE_SET);
 
 	rf_Relation *expected = rf_relation_new_empty(testSet, testSet);
-	expected->table[rf_table_idx(expected,1,1)] = true;
-	expected->table[rf_table_idx(expected,1,2)] = true;
-	expected->table[rf_table_idx(expected,2,2)] = true;
+	rf_relation_set(expected, 1, 1, true);
+	rf_relation_set(expected, 1, 2, true);
+	rf_relation_set(expected, 2, 2, true);
 
 	rf_Relation *result = rf_relation_new_subsetleq(testSet, NULL);
 	for(int i=0;i<n;i++){
-	CU_ASSERT_EQUAL(expected->table[i], result->table[i]);
+	CU_ASSERT_EQUAL(table_at(expected, i), table_at(result, i));
 	}
 	}
 
@@ -409,10 +575,10 @@ void test_rf_relation_is_antisymmetric(){
 	rf_Relation *r1 = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_antisymmetric(r1));
 
-	r1->table[rf_table_idx(r1,0,2)] = true;
+	rf_relation_set(r1, 0, 2, true);
 	CU_ASSERT_TRUE(rf_relation_is_antisymmetric(r1));
 
-	r1->table[rf_table_idx(r1,2,0)] = true;
+	rf_relation_set(r1, 2, 0, true);
 	CU_ASSERT_FALSE(rf_relation_is_antisymmetric(r1));
 	}
 
@@ -423,10 +589,10 @@ void test_rf_relation_is_asymmetric(){
 	CU_ASSERT_FALSE(rf_relation_is_asymmetric(r1));
 
 	r1 = rf_relation_new_empty(set, set);
-	r1->table[rf_table_idx(r1,0,2)] = true;
+	rf_relation_set(r1, 0, 2, true);
 	CU_ASSERT_TRUE(rf_relation_is_asymmetric(r1));
 
-	r1->table[rf_table_idx(r1,2,0)] = true;
+	rf_relation_set(r1, 2, 0, true);
 	CU_ASSERT_FALSE(rf_relation_is_asymmetric(r1));
 }
 
@@ -438,32 +604,45 @@ void test_rf_relation_is_difunctional(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	//Not difunctional, should be false
 	bool returnCode = rf_relation_is_difunctional(rel);
 	CU_ASSERT_FALSE(returnCode);
 
 	//make it difunctional
-	rel->table[rf_table_idx(rel,3,3)] = true;
+	rf_relation_set(rel, 3, 3, true);
 
 	//now it should return true
 	returnCode = rf_relation_is_difunctional(rel);
 	CU_ASSERT_TRUE(returnCode);
 
+	//rows overlapping in a column other than their first are neither equal nor disjoint
+	rf_Relation *overlap = rf_relation_new_empty(mySet, mySet);
+	rf_relation_set(overlap, 0, 1, true);
+	rf_relation_set(overlap, 1, 0, true);
+	rf_relation_set(overlap, 1, 1, true);
+	rf_relation_set(overlap, 2, 0, true);
+	rf_relation_set(overlap, 2, 1, true);
+	CU_ASSERT_FALSE(rf_relation_is_difunctional(overlap));
+
+	rf_relation_set(overlap, 0, 0, true);
+	CU_ASSERT_TRUE(rf_relation_is_difunctional(overlap));
+
+	rf_relation_free(overlap);
 }
 
 void test_rf_relation_is_equivalent(){
 	rf_Relation *full = rf_relation_new_full(set, set);
 	rf_Relation *id = rf_relation_new_id(set);
 	rf_Relation *false1 = rf_relation_new_full(set, set);
-	false1->table[rf_table_idx(false1, 0,0)] = false;
+	rf_relation_set(false1, 0, 0, false);
 	rf_Relation *false2 = rf_relation_new_id(set);
-	false2->table[rf_table_idx(false2, 0,2)] = true;
+	rf_relation_set(false2, 0, 2, true);
 
 	CU_ASSERT_TRUE(rf_relation_is_equivalent(full));
 	CU_ASSERT_TRUE(rf_relation_is_equivalent(id));
@@ -473,24 +652,233 @@ void test_rf_relation_is_equivalent(){
 
 void test_rf_relation_is_symmetric(){
 	rf_Relation *false1 = rf_relation_new_id(set);
-	false1->table[rf_table_idx(false1, 0,2)] = true;
+	rf_relation_set(false1, 0, 2, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_symmetric(false1));
 
-	false1->table[rf_table_idx(false1, 2,0)] = true;
+	rf_relation_set(false1, 2, 0, true);
 
 	CU_ASSERT_TRUE(rf_relation_is_symmetric(false1));
+
+	//only the pair below the diagonal
+	rf_relation_set(false1, 0, 2, false);
+	CU_ASSERT_FALSE(rf_relation_is_symmetric(false1));
+}
+
+void test_rf_relation_properties(){
+	rf_Relation *id = rf_relation_new_id(set);
+	unsigned int expected = RF_PROPERTY_ALL & ~(RF_PROPERTY_IRREFLEXIVE | RF_PROPERTY_ASYMMETRIC);
+	CU_ASSERT_EQUAL(rf_relation_properties(id), expected);
+
+	//a strict order
+	rf_Relation *less = rf_relation_new_empty(set, set);
+	rf_relation_set(less, 0, 1, true);
+	rf_relation_set(less, 0, 2, true);
+	rf_relation_set(less, 1, 2, true);
+	expected = RF_PROPERTY_HOMOGENEOUS | RF_PROPERTY_IRREFLEXIVE | RF_PROPERTY_ANTISYMMETRIC
+	           | RF_PROPERTY_ASYMMETRIC | RF_PROPERTY_TRANSITIVE;
+	CU_ASSERT_EQUAL(rf_relation_properties(less), expected);
+
+	//heterogeneous relations only have the properties of functions
+	rf_Relation *hetero = rf_relation_new_full(set, set2);
+	expected = RF_PROPERTY_LEFTTOTAL | RF_PROPERTY_FUNCTIONAL | RF_PROPERTY_FUNCTION | RF_PROPERTY_SURJECTIVE;
+	CU_ASSERT_EQUAL(rf_relation_properties(hetero), expected);
+
+	rf_relation_free(hetero);
+	rf_relation_free(less);
+	rf_relation_free(id);
+}
+
+void test_rf_relation_property_cache(){
+	rf_Relation *order = rf_relation_new_id(set);
+	rf_relation_set(order, 0, 1, true);
+
+	CU_ASSERT_TRUE(rf_relation_is_partial_order(order));
+	CU_ASSERT_TRUE(order->known & RF_PROPERTY_PARTIAL_ORDER);
+	CU_ASSERT_TRUE(order->known & RF_PROPERTY_HOMOGENEOUS);
+
+	//cell writes drop everything but homogeneity
+	rf_relation_set(order, 1, 0, true);
+	CU_ASSERT_EQUAL(order->known, RF_PROPERTY_HOMOGENEOUS);
+	CU_ASSERT_FALSE(rf_relation_is_partial_order(order));
+
+	//as do the make_* functions
+	CU_ASSERT_FALSE(rf_relation_is_antisymmetric(order));
+	rf_relation_make_complement(order, NULL);
+	CU_ASSERT_EQUAL(order->known, RF_PROPERTY_HOMOGENEOUS);
+
+	//direct row writes need an explicit invalidation
+	CU_ASSERT_FALSE(rf_relation_is_reflexive(order));
+	rf_bitrow_set_all(rf_relation_row(order, 0), set->cardinality);
+	rf_bitrow_set_all(rf_relation_row(order, 1), set->cardinality);
+	rf_bitrow_set_all(rf_relation_row(order, 2), set->cardinality);
+	rf_relation_invalidate(order);
+	CU_ASSERT_TRUE(rf_relation_is_reflexive(order));
+
+	//clones take the cache along
+	rf_Relation *clone = rf_relation_clone(order);
+	CU_ASSERT_EQUAL(clone->known, order->known);
+	CU_ASSERT_EQUAL(clone->properties, order->properties);
+
+	//asymmetry is decided without the transitivity pass
+	rf_relation_invalidate(order);
+	CU_ASSERT_FALSE(rf_relation_is_asymmetric(order));
+	CU_ASSERT_TRUE(order->known & RF_PROPERTY_ASYMMETRIC);
+	CU_ASSERT_FALSE(order->known & RF_PROPERTY_TRANSITIVE);
+
+	rf_relation_free(clone);
+	rf_relation_free(order);
+}
+
+void test_rf_relation_track(){
+	rf_Relation *r = rf_relation_new_empty(set, set);
+	rf_relation_set(r, 0, 1, true);
+	CU_ASSERT_TRUE(rf_relation_track(r, NULL));
+	CU_ASSERT_PTR_NOT_NULL(r->tracker);
+	CU_ASSERT_EQUAL(r->tracker->asymmetric, 1);
+	CU_ASSERT_EQUAL(r->tracker->empty_rows, 2);
+
+	rf_relation_set(r, 1, 0, true);
+	CU_ASSERT_EQUAL(r->tracker->asymmetric, 0);
+	CU_ASSERT_EQUAL(r->tracker->symmetric, 1);
+	CU_ASSERT_TRUE(rf_relation_is_symmetric(r));
+	CU_ASSERT_FALSE(rf_relation_is_antisymmetric(r));
+	CU_ASSERT_TRUE(rf_relation_is_functional(r));
+	CU_ASSERT_FALSE(rf_relation_is_lefttotal(r));
+
+	//setting a cell twice counts once
+	rf_relation_set(r, 2, 2, true);
+	rf_relation_set(r, 2, 2, true);
+	CU_ASSERT_EQUAL(r->tracker->diagonal, 1);
+	CU_ASSERT_TRUE(rf_relation_is_function(r));
+	CU_ASSERT_TRUE(rf_relation_is_bijective(r));
+
+	rf_relation_set(r, 0, 1, false);
+	CU_ASSERT_FALSE(rf_relation_is_symmetric(r));
+	CU_ASSERT_TRUE(rf_relation_is_antisymmetric(r));
+	CU_ASSERT_FALSE(rf_relation_is_lefttotal(r));
+
+	//bulk changes are recounted
+	rf_relation_make_reflexive(r, NULL);
+	rf_relation_make_complement(r, NULL);
+	CU_ASSERT_TRUE(r->tracker->stale);
+	CU_ASSERT_TRUE(rf_relation_is_irreflexive(r));
+	CU_ASSERT_FALSE(r->tracker->stale);
+	CU_ASSERT_EQUAL(r->tracker->asymmetric, 1);
+	CU_ASSERT_EQUAL(r->tracker->symmetric, 2);
+
+	rf_relation_untrack(r);
+	CU_ASSERT_PTR_NULL(r->tracker);
+	CU_ASSERT_TRUE(rf_relation_is_irreflexive(r));
+
+	rf_relation_free(r);
+}
+
+void test_rf_relation_witness(){
+	rf_RelationWitness witness;
+
+	//0 and 1 related both ways, 2 on its own
+	rf_Relation *r = rf_relation_new_empty(set, set);
+	rf_relation_set(r, 0, 1, true);
+	rf_relation_set(r, 1, 0, true);
+	rf_relation_set(r, 1, 1, true);
+
+	CU_ASSERT_FALSE(rf_relation_is_antisymmetric_witness(r, &witness));
+	CU_ASSERT_EQUAL(witness.property, RF_PROPERTY_ANTISYMMETRIC);
+	CU_ASSERT_EQUAL(witness.n, 2);
+	CU_ASSERT_EQUAL(witness.index[0], 0);
+	CU_ASSERT_EQUAL(witness.index[1], 1);
+	CU_ASSERT_PTR_EQUAL(witness.elements[1], r->domains[0]->elements[1]);
+
+	//composites are refuted by their first failing part
+	CU_ASSERT_FALSE(rf_relation_is_equivalent_witness(r, &witness));
+	CU_ASSERT_EQUAL(witness.property, RF_PROPERTY_REFLEXIVE);
+	CU_ASSERT_EQUAL(witness.n, 1);
+	CU_ASSERT_EQUAL(witness.index[0], 0);
+
+	//0R1, 1R1 and 1R0 but not 0R0
+	CU_ASSERT_FALSE(rf_relation_is_difunctional_witness(r, &witness));
+	CU_ASSERT_EQUAL(witness.n, 4);
+	CU_ASSERT_EQUAL(witness.index[0], 0);
+	CU_ASSERT_EQUAL(witness.index[1], 1);
+	CU_ASSERT_EQUAL(witness.index[2], 1);
+	CU_ASSERT_EQUAL(witness.index[3], 0);
+
+	CU_ASSERT_FALSE(rf_relation_is_injective_witness(r, &witness));
+	CU_ASSERT_EQUAL(witness.n, 3);
+	CU_ASSERT_EQUAL(witness.index[0], 0);
+	CU_ASSERT_EQUAL(witness.index[1], 1);
+	CU_ASSERT_EQUAL(witness.index[2], 1);
+
+	CU_ASSERT_TRUE(rf_relation_is_symmetric_witness(r, &witness));
+	CU_ASSERT_EQUAL(witness.n, 0);
+
+	//heterogeneous relations have no witness for homogeneous properties
+	rf_Relation *hetero = rf_relation_new_empty(set, set2);
+	CU_ASSERT_FALSE(rf_relation_is_reflexive_witness(hetero, &witness));
+	CU_ASSERT_EQUAL(witness.property, RF_PROPERTY_HOMOGENEOUS);
+	CU_ASSERT_EQUAL(witness.n, 0);
+
+	CU_ASSERT_FALSE(rf_relation_is_surjective_witness(hetero, &witness));
+	CU_ASSERT_EQUAL(witness.n, 1);
+	CU_ASSERT_PTR_EQUAL(witness.elements[0], hetero->domains[1]->elements[0]);
+
+	//a chain is a lattice, two incomparable elements are not
+	rf_Relation *order = rf_relation_new_id(set);
+	rf_relation_set(order, 2, 0, true);
+	rf_relation_set(order, 2, 1, true);
+	CU_ASSERT_FALSE(rf_relation_is_lattice_witness(order, &witness, NULL));
+	CU_ASSERT_EQUAL(witness.n, 2);
+	CU_ASSERT_EQUAL(witness.index[0], 0);
+	CU_ASSERT_EQUAL(witness.index[1], 1);
+
+	rf_relation_set(order, 1, 0, true);
+	CU_ASSERT_TRUE(rf_relation_is_lattice_witness(order, &witness, NULL));
+
+	rf_relation_free(order);
+	rf_relation_free(hetero);
+	rf_relation_free(r);
+}
+
+void test_rf_relation_count_violations(){
+	rf_Relation *full = rf_relation_new_full(set, set);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(full, RF_PROPERTY_IRREFLEXIVE, NULL), 3);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(full, RF_PROPERTY_ANTISYMMETRIC, NULL), 3);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(full, RF_PROPERTY_FUNCTIONAL, NULL), 3);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(full, RF_PROPERTY_TRANSITIVE, NULL), 0);
+
+	//R;R adds 0R2, 1R1 and 2R2; rows 0 and 2 sharing column 1 are equal
+	rf_Relation *r = rf_relation_new_empty(set, set);
+	rf_relation_set(r, 0, 1, true);
+	rf_relation_set(r, 1, 2, true);
+	rf_relation_set(r, 2, 1, true);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(r, RF_PROPERTY_REFLEXIVE, NULL), 3);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(r, RF_PROPERTY_SYMMETRIC, NULL), 1);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(r, RF_PROPERTY_TRANSITIVE, NULL), 3);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(r, RF_PROPERTY_DIFUNCTIONAL, NULL), 0);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(r, RF_PROPERTY_INJECTIVE, NULL), 1);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(r, RF_PROPERTY_SURJECTIVE, NULL), 1);
+
+	rf_Error error;
+	rf_Relation *hetero = rf_relation_new_full(set, set2);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(hetero, RF_PROPERTY_INJECTIVE, &error), 1);
+	CU_ASSERT_EQUAL(rf_relation_count_violations(hetero, RF_PROPERTY_SYMMETRIC, &error), 0);
+	CU_ASSERT_EQUAL(error.code, RF_E_REL_NOT_HOMOGENEOUS);
+
+	rf_relation_free(hetero);
+	rf_relation_free(r);
+	rf_relation_free(full);
 }
 
 void test_rf_relation_is_irreflexive(){
 	//true examples
 	rf_Relation *true1 = rf_relation_new_empty(set, set);
 	rf_Relation *true2 = rf_relation_new_empty(set, set);
-	true2->table[rf_table_idx(true2, 0,2)] = true;
+	rf_relation_set(true2, 0, 2, true);
 
 	//false examples
 	rf_Relation *false2 = rf_relation_new_full(set, set);
-	false2->table[rf_table_idx(false2, 0,0)] = false;
+	rf_relation_set(false2, 0, 0, false);
 	rf_Relation *false3 = rf_relation_new_id(set);
 	rf_Relation *false4 = rf_relation_new_empty(set, set2);
 
@@ -506,10 +894,10 @@ void test_rf_relation_is_reflexive(){
 	rf_Relation *id = rf_relation_new_id(set);
 	rf_Relation *full = rf_relation_new_full(set, set);
 	rf_Relation *true3 = rf_relation_new_id(set);
-	true3->table[rf_table_idx(true3, 0,2)] = true;
+	rf_relation_set(true3, 0, 2, true);
 
 	rf_Relation *false1 = rf_relation_new_full(set, set);
-	false1->table[rf_table_idx(false1, 0,0)] = false;
+	rf_relation_set(false1, 0, 0, false);
 	rf_Relation *empty = rf_relation_new_empty(set, set);
 
 	CU_ASSERT_TRUE(rf_relation_is_reflexive(id));
@@ -534,43 +922,53 @@ void test_rf_relation_is_transitive(){
 	rf_Relation *full = rf_relation_new_full(set, set);
 	rf_Relation *empty = rf_relation_new_empty(set, set);
 	rf_Relation *variation = rf_relation_new_empty(set, set);
-	variation->table[rf_table_idx(variation, 0,1)] = true;
+	rf_relation_set(variation, 0, 1, true);
 
 	CU_ASSERT_TRUE(rf_relation_is_transitive(full));
 	CU_ASSERT_TRUE(rf_relation_is_transitive(empty));
 
 	CU_ASSERT_TRUE(rf_relation_is_transitive(variation));
 
-	variation->table[rf_table_idx(variation, 1,2)] = true;
+	rf_relation_set(variation, 1, 2, true);
 	CU_ASSERT_FALSE(rf_relation_is_transitive(variation));
 
-	variation->table[rf_table_idx(variation, 0,2)] = true;
+	rf_RelationWitness witness;
+	CU_ASSERT_FALSE(rf_relation_is_transitive_witness(variation, &witness));
+	CU_ASSERT_EQUAL(witness.n, 3);
+	CU_ASSERT_EQUAL(witness.index[0], 0);
+	CU_ASSERT_EQUAL(witness.index[1], 1);
+	CU_ASSERT_EQUAL(witness.index[2], 2);
+	CU_ASSERT_PTR_EQUAL(witness.elements[2], variation->domains[0]->elements[2]);
+
+	rf_relation_set(variation, 0, 2, true);
 	CU_ASSERT_TRUE(rf_relation_is_transitive(variation));
+	CU_ASSERT_TRUE(rf_relation_is_transitive_witness(variation, &witness));
+	CU_ASSERT_EQUAL(witness.n, 0);
 }
 
 void test_rf_relation_find_maximum(){
 	rf_Relation *id = rf_relation_new_id(set);
 
-	id->table[rf_table_idx(id, 0,1)] = true;
-	id->table[rf_table_idx(id, 1,2)] = true;
-	id->table[rf_table_idx(id, 1,0)] = true;
+	rf_relation_set(id, 0, 1, true);
+	rf_relation_set(id, 1, 2, true);
+	rf_relation_set(id, 1, 0, true);
 
 	CU_ASSERT_EQUAL(rf_relation_find_maximum(id, NULL), NULL);
-	id->table[rf_table_idx(id, 0,1)] = false;
+	rf_relation_set(id, 0, 1, false);
 	CU_ASSERT_TRUE(rf_set_element_equal(rf_relation_find_maximum(id, NULL), id->domains[0]->elements[1]));
 }
 
 void test_rf_relation_find_minimum(){
 	rf_Relation *id = rf_relation_new_id(set);
-	id->table[rf_table_idx(id, 0,2)] = true;
-	id->table[rf_table_idx(id, 1,2)] = true;
+	rf_relation_set(id, 0, 2, true);
+	rf_relation_set(id, 1, 2, true);
 	CU_ASSERT_TRUE(rf_set_element_equal(rf_relation_find_minimum(id, NULL),id->domains[0]->elements[2]));
 
-	id->table[rf_table_idx(id, 0,1)] = true;
-	id->table[rf_table_idx(id, 0,2)] = false;
-	id->table[rf_table_idx(id, 1,0)] = true;
+	rf_relation_set(id, 0, 1, true);
+	rf_relation_set(id, 0, 2, false);
+	rf_relation_set(id, 1, 0, true);
 	CU_ASSERT_EQUAL(rf_relation_find_minimum(id, NULL), NULL);
-	id->table[rf_table_idx(id, 0,1)] = false;
+	rf_relation_set(id, 0, 1, false);
 	CU_ASSERT_EQUAL(rf_relation_find_minimum(id, NULL), NULL);
 }
 
@@ -591,14 +989,14 @@ void test_rf_relation_find_maximum_within_subset(){
 	rf_Set *subset = rf_set_new(1, elems2);
 
 	rf_Relation *relation2 = rf_relation_new_id(superSet);
-	relation2->table[rf_table_idx(relation2, 0,2)] = true;
-	relation2->table[rf_table_idx(relation2, 0,3)] = true;
-	relation2->table[rf_table_idx(relation2, 0,4)] = true;
-	relation2->table[rf_table_idx(relation2, 1,2)] = true;
-	relation2->table[rf_table_idx(relation2, 1,3)] = true;
-	relation2->table[rf_table_idx(relation2, 1,4)] = true;
-	relation2->table[rf_table_idx(relation2, 2,4)] = true;
-	relation2->table[rf_table_idx(relation2, 3,4)] = true;
+	rf_relation_set(relation2, 0, 2, true);
+	rf_relation_set(relation2, 0, 3, true);
+	rf_relation_set(relation2, 0, 4, true);
+	rf_relation_set(relation2, 1, 2, true);
+	rf_relation_set(relation2, 1, 3, true);
+	rf_relation_set(relation2, 1, 4, true);
+	rf_relation_set(relation2, 2, 4, true);
+	rf_relation_set(relation2, 3, 4, true);
 
 	rf_SetElement *expected = rf_relation_find_maximum_within_subset(relation2, subset, NULL);
 
@@ -612,15 +1010,15 @@ void test_rf_relation_find_maximum_within_subset(){
 	  rf_Set *superSet2 = rf_set_new(9, elems6);
 	  relation2 = rf_relation_new_top(superSet2);
 
-	  relation2->table[rf_table_idx(relation2, 1, 2)] = false;
-	  relation2->table[rf_table_idx(relation2, 1, 5)] = false;
-	  relation2->table[rf_table_idx(relation2, 2, 3)] = false;
-	  relation2->table[rf_table_idx(relation2, 3, 4)] = false;
-	  relation2->table[rf_table_idx(relation2, 3, 5)] = false;
-	  relation2->table[rf_table_idx(relation2, 3, 7)] = false;
-	  relation2->table[rf_table_idx(relation2, 4, 5)] = false;
-	  relation2->table[rf_table_idx(relation2, 5, 6)] = false;
-	  relation2->table[rf_table_idx(relation2, 6, 7)] = false;
+	  rf_relation_set(relation2, 1, 2, false);
+	  rf_relation_set(relation2, 1, 5, false);
+	  rf_relation_set(relation2, 2, 3, false);
+	  rf_relation_set(relation2, 3, 4, false);
+	  rf_relation_set(relation2, 3, 5, false);
+	  rf_relation_set(relation2, 3, 7, false);
+	  rf_relation_set(relation2, 4, 5, false);
+	  rf_relation_set(relation2, 5, 6, false);
+	  rf_relation_set(relation2, 6, 7, false);
 
 	  rf_SetElement *elems5[3];
 
@@ -641,15 +1039,15 @@ void test_rf_relation_find_minimal_elements(){
 	rf_Set *superSet2 = rf_set_new(9, elems6);
 	rf_Relation *relation2 = rf_relation_new_top(superSet2);
 
-	relation2->table[rf_table_idx(relation2, 1, 2)] = false;
-	relation2->table[rf_table_idx(relation2, 1, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 2, 3)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 4)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 7)] = false;
-	relation2->table[rf_table_idx(relation2, 4, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 5, 6)] = false;
-	relation2->table[rf_table_idx(relation2, 6, 7)] = false;
+	rf_relation_set(relation2, 1, 2, false);
+	rf_relation_set(relation2, 1, 5, false);
+	rf_relation_set(relation2, 2, 3, false);
+	rf_relation_set(relation2, 3, 4, false);
+	rf_relation_set(relation2, 3, 5, false);
+	rf_relation_set(relation2, 3, 7, false);
+	rf_relation_set(relation2, 4, 5, false);
+	rf_relation_set(relation2, 5, 6, false);
+	rf_relation_set(relation2, 6, 7, false);
 
 	rf_SetElement *elems5[3];
 
@@ -657,7 +1055,7 @@ void test_rf_relation_find_minimal_elements(){
 	elems5[1] = rf_set_element_new_string(g);
 	elems5[2] = rf_set_element_new_string(i);
 
-	rf_SetElement *elems7[2];
+	rf_SetElement *elems7[3];
 	elems7[0] = rf_set_element_new_string(b);
 	elems7[1] = rf_set_element_new_string(d);
 	elems7[2] = rf_set_element_new_string(e);
@@ -679,23 +1077,23 @@ void test_rf_relation_find_maximal_elements(){
 	rf_Set *superSet2 = rf_set_new(9, elems6);
 	rf_Relation *relation2 = rf_relation_new_top(superSet2);
 
-	relation2->table[rf_table_idx(relation2, 1, 2)] = false;
-	relation2->table[rf_table_idx(relation2, 1, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 2, 3)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 4)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 7)] = false;
-	relation2->table[rf_table_idx(relation2, 4, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 5, 6)] = false;
-	relation2->table[rf_table_idx(relation2, 6, 7)] = false;
+	rf_relation_set(relation2, 1, 2, false);
+	rf_relation_set(relation2, 1, 5, false);
+	rf_relation_set(relation2, 2, 3, false);
+	rf_relation_set(relation2, 3, 4, false);
+	rf_relation_set(relation2, 3, 5, false);
+	rf_relation_set(relation2, 3, 7, false);
+	rf_relation_set(relation2, 4, 5, false);
+	rf_relation_set(relation2, 5, 6, false);
+	rf_relation_set(relation2, 6, 7, false);
 
-	rf_SetElement *elems5[4];
+	rf_SetElement *elems5[3];
 
 	elems5[0] = rf_set_element_new_string(d);
 	elems5[1] = rf_set_element_new_string(g);
 	elems5[2] = rf_set_element_new_string(i);
 
-	rf_SetElement *elems7[2];
+	rf_SetElement *elems7[3];
 	elems7[0] = rf_set_element_new_string(b);
 	elems7[1] = rf_set_element_new_string(d);
 	elems7[2] = rf_set_element_new_string(c);
@@ -735,9 +1133,9 @@ void test_rf_relation_find_supremum(){
 	rf_Set *subset2 = rf_set_new(2, elems3);
 
 	rf_Relation *relation = rf_relation_new_id(superSet);
-	relation->table[rf_table_idx(relation, 0,3)] = true;
-	relation->table[rf_table_idx(relation, 1,0)] = true;
-	relation->table[rf_table_idx(relation, 1,3)] = true;
+	rf_relation_set(relation, 0, 3, true);
+	rf_relation_set(relation, 1, 0, true);
+	rf_relation_set(relation, 1, 3, true);
 
 	rf_SetElement *expected = rf_relation_find_supremum(relation, subset2, NULL);
 
@@ -751,15 +1149,15 @@ void test_rf_relation_find_supremum(){
 	rf_Set *superSet2 = rf_set_new(9, elems4);
 	rf_Relation *relation2 = rf_relation_new_top(superSet2);
 
-	relation2->table[rf_table_idx(relation2, 1, 2)] = false;
-	relation2->table[rf_table_idx(relation2, 1, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 2, 3)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 4)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 7)] = false;
-	relation2->table[rf_table_idx(relation2, 4, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 5, 6)] = false;
-	relation2->table[rf_table_idx(relation2, 6, 7)] = false;
+	rf_relation_set(relation2, 1, 2, false);
+	rf_relation_set(relation2, 1, 5, false);
+	rf_relation_set(relation2, 2, 3, false);
+	rf_relation_set(relation2, 3, 4, false);
+	rf_relation_set(relation2, 3, 5, false);
+	rf_relation_set(relation2, 3, 7, false);
+	rf_relation_set(relation2, 4, 5, false);
+	rf_relation_set(relation2, 5, 6, false);
+	rf_relation_set(relation2, 6, 7, false);
 
 	rf_SetElement *elems5[2];
 
@@ -790,14 +1188,14 @@ void test_rf_relation_find_infimum(){
 	rf_Set *subset4 = rf_set_new(3, elems4);
 
 	rf_Relation *relation = rf_relation_new_id(superSet);
-	relation->table[rf_table_idx(relation, 0,2)] = true;
-	relation->table[rf_table_idx(relation, 1,2)] = true;
-	relation->table[rf_table_idx(relation, 0,3)] = true;
-	relation->table[rf_table_idx(relation, 1,3)] = true;
-	relation->table[rf_table_idx(relation, 0,4)] = true;
-	relation->table[rf_table_idx(relation, 1,4)] = true;
-	relation->table[rf_table_idx(relation, 2,4)] = true;
-	relation->table[rf_table_idx(relation, 3,4)] = true;
+	rf_relation_set(relation, 0, 2, true);
+	rf_relation_set(relation, 1, 2, true);
+	rf_relation_set(relation, 0, 3, true);
+	rf_relation_set(relation, 1, 3, true);
+	rf_relation_set(relation, 0, 4, true);
+	rf_relation_set(relation, 1, 4, true);
+	rf_relation_set(relation, 2, 4, true);
+	rf_relation_set(relation, 3, 4, true);
 
 	//ab
 	rf_SetElement *expected = rf_relation_find_infimum(relation, subset2, NULL);
@@ -818,15 +1216,15 @@ void test_rf_relation_find_infimum(){
 	rf_Set *superSet2 = rf_set_new(9, elems6);
 	rf_Relation *relation2 = rf_relation_new_top(superSet2);
 
-	relation2->table[rf_table_idx(relation2, 1, 2)] = false;
-	relation2->table[rf_table_idx(relation2, 1, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 2, 3)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 4)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 7)] = false;
-	relation2->table[rf_table_idx(relation2, 4, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 5, 6)] = false;
-	relation2->table[rf_table_idx(relation2, 6, 7)] = false;
+	rf_relation_set(relation2, 1, 2, false);
+	rf_relation_set(relation2, 1, 5, false);
+	rf_relation_set(relation2, 2, 3, false);
+	rf_relation_set(relation2, 3, 4, false);
+	rf_relation_set(relation2, 3, 5, false);
+	rf_relation_set(relation2, 3, 7, false);
+	rf_relation_set(relation2, 4, 5, false);
+	rf_relation_set(relation2, 5, 6, false);
+	rf_relation_set(relation2, 6, 7, false);
 
 	rf_SetElement *elems5[2];
 
@@ -868,9 +1266,9 @@ void test_rf_relation_find_upperbound(){
 	rf_Set *subset2 = rf_set_new(2, elems3);
 
 	rf_Relation *relation = rf_relation_new_id(superSet);
-	relation->table[rf_table_idx(relation, 0,3)] = true;
-	relation->table[rf_table_idx(relation, 1,0)] = true;
-	relation->table[rf_table_idx(relation, 1,3)] = true;
+	rf_relation_set(relation, 0, 3, true);
+	rf_relation_set(relation, 1, 0, true);
+	rf_relation_set(relation, 1, 3, true);
 
 	rf_Set *expected = rf_relation_find_upperbound(relation, subset1, NULL);
 	rf_Set *expected2 = rf_relation_find_upperbound(relation, subset2, NULL);
@@ -892,20 +1290,94 @@ void test_rf_relation_find_upperbound(){
 	rf_Set *subset3 = rf_set_new(2, elems5);
 
 	rf_Relation *relation2 = rf_relation_new_id(superSet2);
-	relation2->table[rf_table_idx(relation2, 2,0)] = true;
-	relation2->table[rf_table_idx(relation2, 2,1)] = true;
-	relation2->table[rf_table_idx(relation2, 3,0)] = true;
-	relation2->table[rf_table_idx(relation2, 3,1)] = true;
-	relation2->table[rf_table_idx(relation2, 4,0)] = true;
-	relation2->table[rf_table_idx(relation2, 4,1)] = true;
-	relation2->table[rf_table_idx(relation2, 4,2)] = true;
-	relation2->table[rf_table_idx(relation2, 4,3)] = true;
+	rf_relation_set(relation2, 2, 0, true);
+	rf_relation_set(relation2, 2, 1, true);
+	rf_relation_set(relation2, 3, 0, true);
+	rf_relation_set(relation2, 3, 1, true);
+	rf_relation_set(relation2, 4, 0, true);
+	rf_relation_set(relation2, 4, 1, true);
+	rf_relation_set(relation2, 4, 2, true);
+	rf_relation_set(relation2, 4, 3, true);
 
 	rf_Set *expected3 = rf_relation_find_upperbound(relation2, subset3, NULL);
 
 	CU_ASSERT_EQUAL(expected3->cardinality, 3);
 }
 
+void test_rf_relation_index_queries(){
+	//4 above 2 and 3, both above 0 and 1
+	rf_SetElement *elems[5];
+	generateTestElements(5, elems);
+	rf_Set *superSet = rf_set_new(5, elems);
+
+	rf_Relation *relation = rf_relation_new_id(superSet);
+	rf_relation_set(relation, 2, 0, true);
+	rf_relation_set(relation, 2, 1, true);
+	rf_relation_set(relation, 3, 0, true);
+	rf_relation_set(relation, 3, 1, true);
+	rf_relation_set(relation, 4, 0, true);
+	rf_relation_set(relation, 4, 1, true);
+	rf_relation_set(relation, 4, 2, true);
+	rf_relation_set(relation, 4, 3, true);
+
+	rf_IndexSet *bottom = rf_index_set_new(5);
+	rf_index_set_add(bottom, 0);
+	rf_index_set_add(bottom, 1);
+	rf_IndexSet *middle = rf_index_set_new(5);
+	rf_index_set_add(middle, 2);
+	rf_index_set_add(middle, 3);
+
+	rf_IndexSet *result = rf_index_set_new(5);
+	CU_ASSERT_TRUE(rf_relation_upper_bounds(relation, bottom, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 3);
+	CU_ASSERT_FALSE(rf_index_set_contains(result, 1));
+	CU_ASSERT_TRUE(rf_index_set_contains(result, 2));
+	CU_ASSERT_TRUE(rf_index_set_contains(result, 4));
+
+	CU_ASSERT_TRUE(rf_relation_lower_bounds(relation, middle, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 2);
+	CU_ASSERT_TRUE(rf_index_set_contains(result, 0));
+	CU_ASSERT_TRUE(rf_index_set_contains(result, 1));
+
+	//every element bounds the empty subset
+	rf_IndexSet *empty = rf_index_set_new(5);
+	CU_ASSERT_TRUE(rf_relation_upper_bounds(relation, empty, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 5);
+
+	//the whole order has a single minimal and maximal element
+	rf_IndexSet *all = rf_index_set_new_full(5);
+	CU_ASSERT_TRUE(rf_relation_minimal_elements(relation, middle, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 2);
+	CU_ASSERT_TRUE(rf_relation_minimal_elements(relation, all, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 2);
+	CU_ASSERT_TRUE(rf_index_set_contains(result, 0));
+	CU_ASSERT_TRUE(rf_relation_maximal_elements(relation, all, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 1);
+	CU_ASSERT_TRUE(rf_index_set_contains(result, 4));
+
+	//image and preimage
+	rf_relation_image(relation, middle, result);
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 4);
+	CU_ASSERT_FALSE(rf_index_set_contains(result, 4));
+	rf_relation_preimage(relation, middle, result);
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 3);
+	CU_ASSERT_FALSE(rf_index_set_contains(result, 0));
+
+	//changes to the table reach the cached transpose
+	rf_relation_set(relation, 3, 0, false);
+	CU_ASSERT_TRUE(rf_relation_upper_bounds(relation, bottom, result, NULL));
+	CU_ASSERT_EQUAL(rf_index_set_count(result), 2);
+	CU_ASSERT_FALSE(rf_index_set_contains(result, 3));
+
+	rf_index_set_free(all);
+	rf_index_set_free(empty);
+	rf_index_set_free(result);
+	rf_index_set_free(middle);
+	rf_index_set_free(bottom);
+	rf_relation_free(relation);
+	rf_set_free(superSet);
+}
+
 void test_rf_relation_find_lowerbound(){
 
 	rf_SetElement *elems[5];
@@ -928,14 +1400,14 @@ void test_rf_relation_find_lowerbound(){
 	rf_Set *subset3 = rf_set_new(2, elems4);
 
 	rf_Relation *relation2 = rf_relation_new_id(superSet);
-	relation2->table[rf_table_idx(relation2, 0,2)] = true;
-	relation2->table[rf_table_idx(relation2, 0,3)] = true;
-	relation2->table[rf_table_idx(relation2, 0,4)] = true;
-	relation2->table[rf_table_idx(relation2, 1,2)] = true;
-	relation2->table[rf_table_idx(relation2, 1,3)] = true;
-	relation2->table[rf_table_idx(relation2, 1,4)] = true;
-	relation2->table[rf_table_idx(relation2, 2,4)] = true;
-	relation2->table[rf_table_idx(relation2, 3,4)] = true;
+	rf_relation_set(relation2, 0, 2, true);
+	rf_relation_set(relation2, 0, 3, true);
+	rf_relation_set(relation2, 0, 4, true);
+	rf_relation_set(relation2, 1, 2, true);
+	rf_relation_set(relation2, 1, 3, true);
+	rf_relation_set(relation2, 1, 4, true);
+	rf_relation_set(relation2, 2, 4, true);
+	rf_relation_set(relation2, 3, 4, true);
 
 	rf_Set *expected = rf_relation_find_lowerbound(relation2, subset, NULL);
 
@@ -962,15 +1434,15 @@ void test_rf_relation_find_lowerbound(){
 	rf_Set *superSet2 = rf_set_new(9, elems6);
 	relation2 = rf_relation_new_top(superSet2);
 
-	relation2->table[rf_table_idx(relation2, 1, 2)] = false;
-	relation2->table[rf_table_idx(relation2, 1, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 2, 3)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 4)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 3, 7)] = false;
-	relation2->table[rf_table_idx(relation2, 4, 5)] = false;
-	relation2->table[rf_table_idx(relation2, 5, 6)] = false;
-	relation2->table[rf_table_idx(relation2, 6, 7)] = false;
+	rf_relation_set(relation2, 1, 2, false);
+	rf_relation_set(relation2, 1, 5, false);
+	rf_relation_set(relation2, 2, 3, false);
+	rf_relation_set(relation2, 3, 4, false);
+	rf_relation_set(relation2, 3, 5, false);
+	rf_relation_set(relation2, 3, 7, false);
+	rf_relation_set(relation2, 4, 5, false);
+	rf_relation_set(relation2, 5, 6, false);
+	rf_relation_set(relation2, 6, 7, false);
 
 	rf_SetElement *elems5[2];
 
@@ -985,8 +1457,8 @@ void test_rf_relation_find_lowerbound(){
 
 void test_rf_relation_make_transitive(){
 	rf_Relation *variation = rf_relation_new_empty(set, set);
-	variation->table[rf_table_idx(variation, 0,1)] = true;
-	variation->table[rf_table_idx(variation, 1,2)] = true;
+	rf_relation_set(variation, 0, 1, true);
+	rf_relation_set(variation, 1, 2, true);
 
 	//take intransitive relation
 	CU_ASSERT_FALSE(rf_relation_is_transitive(variation));
@@ -997,10 +1469,10 @@ void test_rf_relation_make_transitive(){
 	//test it
 	CU_ASSERT_TRUE(returnCode);
 	CU_ASSERT_TRUE(rf_relation_is_transitive(variation));
-	CU_ASSERT_TRUE(variation->table[rf_table_idx(variation, 0,2)]);
+	CU_ASSERT_TRUE(rf_relation_get(variation, 0, 2));
 
 	//undo changes (make it intransitive again)
-	variation->table[rf_table_idx(variation, 0,2)] = false;
+	rf_relation_set(variation, 0, 2, false);
 	CU_ASSERT_FALSE(rf_relation_is_transitive(variation));
 
 	//make it transitive by deleting relations that would cause intransitivity
@@ -1009,7 +1481,7 @@ void test_rf_relation_make_transitive(){
 	//test it again
 	CU_ASSERT_TRUE(returnCode);
 	CU_ASSERT_TRUE(rf_relation_is_transitive(variation));
-	CU_ASSERT_FALSE(variation->table[rf_table_idx(variation, 1,2)]);
+	CU_ASSERT_FALSE(rf_relation_get(variation, 1, 2));
 
 	//another example
 
@@ -1020,16 +1492,39 @@ void test_rf_relation_make_transitive(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	returnCode = rf_relation_make_transitive(rel, true, NULL);
 
 	CU_ASSERT_TRUE(returnCode);
 	CU_ASSERT_TRUE(rf_relation_is_transitive(rel));
+
+	//a chain backwards over several panels of pivots
+
+	int n = 200;
+	rf_SetElement *chainElems[n];
+	generateTestElements(n, chainElems);
+	rf_Set *chainSet = rf_set_new(n, chainElems);
+	rf_Relation *chain = rf_relation_new_empty(chainSet, chainSet);
+	for(int x = 1; x < n; x++){
+		rf_relation_set(chain, x, x-1, true);
+	}
+
+	CU_ASSERT_TRUE(rf_relation_make_transitive(chain, true, NULL));
+	for(int x = 0; x < n; x++){
+		for(int y = 0; y < n; y++){
+			CU_ASSERT_EQUAL(rf_relation_get(chain, x, y), y < x);
+		}
+	}
+
+	rf_relation_free(chain);
+	rf_set_free(chainSet);
+	rf_relation_free(rel);
+	rf_set_free(mySet);
 }
 
 void test_rf_relation_is_lefttotal(){
@@ -1038,11 +1533,11 @@ void test_rf_relation_is_lefttotal(){
 	rf_Relation *rel = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_lefttotal(rel));
 
-	rel->table[rf_table_idx(rel, 0, 0)] = false;
+	rf_relation_set(rel, 0, 0, false);
 	CU_ASSERT_FALSE(rf_relation_is_lefttotal(rel));
 
-	rel->table[rf_table_idx(rel, 0, 2)] = true;
-	rel->table[rf_table_idx(rel, 0, 1)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 1, true);
 
 	CU_ASSERT_TRUE(rf_relation_is_lefttotal(rel));
 }
@@ -1053,11 +1548,11 @@ void test_rf_relation_is_functional(){
 	rf_Relation *rel = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_functional(rel));
 
-	rel->table[rf_table_idx(rel, 0, 0)] = false;
+	rf_relation_set(rel, 0, 0, false);
 	CU_ASSERT_TRUE(rf_relation_is_functional(rel));
 
-	rel->table[rf_table_idx(rel, 0, 2)] = true;
-	rel->table[rf_table_idx(rel, 0, 1)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 1, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_functional(rel));
 
@@ -1069,11 +1564,11 @@ void test_rf_relation_is_function(){
 	rf_Relation *rel = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_function(rel));
 
-	rel->table[rf_table_idx(rel, 0, 0)] = false;
+	rf_relation_set(rel, 0, 0, false);
 	CU_ASSERT_FALSE(rf_relation_is_function(rel));
 
-	rel->table[rf_table_idx(rel, 0, 2)] = true;
-	rel->table[rf_table_idx(rel, 0, 1)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 1, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_function(rel));
 
@@ -1085,15 +1580,15 @@ void test_rf_relation_is_surjective(){
 	rf_Relation *rel = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_surjective(rel));
 
-	rel->table[rf_table_idx(rel, 0, 0)] = false;
+	rf_relation_set(rel, 0, 0, false);
 	CU_ASSERT_FALSE(rf_relation_is_surjective(rel));
 
-	rel->table[rf_table_idx(rel, 0, 2)] = true;
-	rel->table[rf_table_idx(rel, 0, 1)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 1, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_surjective(rel));
 
-	rel->table[rf_table_idx(rel, 2, 0)] = true;
+	rf_relation_set(rel, 2, 0, true);
 	CU_ASSERT_TRUE(rf_relation_is_surjective(rel));
 
 }
@@ -1104,11 +1599,11 @@ void test_rf_relation_is_injective(){
 	rf_Relation *rel = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_injective(rel));
 
-	rel->table[rf_table_idx(rel, 0, 0)] = false;
+	rf_relation_set(rel, 0, 0, false);
 	CU_ASSERT_TRUE(rf_relation_is_injective(rel));
 
-	rel->table[rf_table_idx(rel, 2, 0)] = true;
-	rel->table[rf_table_idx(rel, 2, 1)] = true;
+	rf_relation_set(rel, 2, 0, true);
+	rf_relation_set(rel, 2, 1, true);
 	CU_ASSERT_FALSE(rf_relation_is_injective(rel));
 }
 
@@ -1118,13 +1613,13 @@ void test_rf_relation_is_bijective(){
 	rf_Relation *rel = rf_relation_new_id(set);
 	CU_ASSERT_TRUE(rf_relation_is_bijective(rel));
 
-	rel->table[rf_table_idx(rel, 0, 0)] = false;
+	rf_relation_set(rel, 0, 0, false);
 	CU_ASSERT_FALSE(rf_relation_is_bijective(rel));
 
-	rel->table[rf_table_idx(rel, 2, 0)] = true;
+	rf_relation_set(rel, 2, 0, true);
 	CU_ASSERT_TRUE(rf_relation_is_bijective(rel));
 
-	rel->table[rf_table_idx(rel, 2, 1)] = true;
+	rf_relation_set(rel, 2, 1, true);
 	CU_ASSERT_FALSE(rf_relation_is_bijective(rel));
 }
 
@@ -1135,16 +1630,16 @@ void test_rf_relation_find_transitive_gaps(){
 	rf_Set *mySet = rf_set_new(4, elems);
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	const int expectedNumOfGaps = 5;
 	const int expected[16] = {0,0,2,1,3,0,0,0,0,3,0,0,0,0,1,0};
 
-	int *occurrences = malloc(sizeof(int)*rel->domains[0]->cardinality*rel->domains[0]->cardinality);
+	int *occurrences = calloc(rel->domains[0]->cardinality*rel->domains[0]->cardinality, sizeof(int));
 	rf_Set *gaps = rf_set_new(0, malloc(0));
 
 	int numOfGaps = rf_relation_find_transitive_gaps(rel, occurrences, gaps, NULL);
@@ -1168,11 +1663,11 @@ void test_rf_relation_guess_transitive_core(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	bool success = rf_relation_guess_transitive_core(rel, NULL);
 
@@ -1189,8 +1684,8 @@ void test_rf_relation_guess_transitive_core(){
 		rf_Relation *bigRel = rf_relation_new_empty(bigSet, bigSet);
 
 		for(int i=0;i<testsize-1;i++){
-		  bigRel->table[rf_table_idx(bigRel, i,testsize-1)] = true;
-		  bigRel->table[rf_table_idx(bigRel, testsize-1,i)] = true;
+		  rf_relation_set(bigRel, i, testsize-1, true);
+		  rf_relation_set(bigRel, testsize-1, i, true);
 		}
 
 		bool success = rf_relation_guess_transitive_core(bigRel, NULL);
@@ -1208,18 +1703,18 @@ void test_rf_relation_find_transitive_hard_core(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	rf_Relation *result = rf_relation_find_transitive_hard_core(rel, NULL);
 
 	int relationsCount = 0;
 	CU_ASSERT_TRUE(rf_relation_is_transitive(result));
 	for(int i = 0; i<16;i++){
-	if(result->table[i])
+	if(table_at(result, i))
 		relationsCount++;
 	}
 	CU_ASSERT_EQUAL(3, relationsCount);
@@ -1236,8 +1731,8 @@ void test_rf_relation_find_transitive_hard_core(){
 		rf_Relation *bigRel = rf_relation_new_empty(bigSet, bigSet);
 
 		for(int i = 0; i < testsize-1; i++){
-			bigRel->table[rf_table_idx(bigRel, i,testsize-1)] = true;
-			bigRel->table[rf_table_idx(bigRel, testsize-1,i)] = true;
+			rf_relation_set(bigRel, i, testsize-1, true);
+			rf_relation_set(bigRel, testsize-1, i, true);
 		}
 
 		result = rf_relation_find_transitive_hard_core(bigRel, NULL);
@@ -1245,7 +1740,7 @@ void test_rf_relation_find_transitive_hard_core(){
 		relationsCount = 0;
 		CU_ASSERT_TRUE(rf_relation_is_transitive(result));
 		for(int i = 0; i < testsize*testsize; i++){
-			if(result->table[i])
+			if(table_at(result, i))
 				relationsCount++;
 		}
 		CU_ASSERT_EQUAL(testsize-1, relationsCount);
@@ -1260,7 +1755,7 @@ void test_rf_relation_get_image(){
 	CU_ASSERT_TRUE(result->cardinality == 3);
 	CU_ASSERT_TRUE(rf_set_equal(set, result));
 
-	rel->table[4] = false;
+	rf_relation_set(rel, 1, 1, false);
 
 	result = rf_relation_get_image(rel, rel->domains[0]);
 	CU_ASSERT_TRUE(result->cardinality == 2);
@@ -1280,7 +1775,7 @@ void test_rf_relation_get_image(){
 	CU_ASSERT_TRUE(rf_set_contains_element(result, set->elements[0]));
 	CU_ASSERT_TRUE(rf_set_contains_element(result, set->elements[2]));
 
-	rel->table[4] = true;
+	rf_relation_set(rel, 1, 1, true);
 
 	result = rf_relation_get_image(rel, subset);
 	CU_ASSERT_TRUE(result->cardinality == 2);
@@ -1296,7 +1791,7 @@ void test_rf_relation_get_preimage(){
 	CU_ASSERT_TRUE(result->cardinality == 3);
 	CU_ASSERT_TRUE(rf_set_equal(set, result));
 
-	rel->table[0] = false;
+	rf_relation_set(rel, 0, 0, false);
 
 	result = rf_relation_get_preImage(rel, rel->domains[0]);
 	CU_ASSERT_TRUE(result->cardinality == 2);
@@ -1315,7 +1810,7 @@ void test_rf_relation_get_preimage(){
 	CU_ASSERT_TRUE(result->cardinality == 1);
 	CU_ASSERT_TRUE(rf_set_contains_element(result, set->elements[2]));
 
-	rel->table[0] = true;
+	rf_relation_set(rel, 0, 0, true);
 
 	result = rf_relation_get_preImage(rel, subset);
 	CU_ASSERT_TRUE(result->cardinality == 2);
@@ -1333,19 +1828,19 @@ void test_rf_relation_is_lattice(){
 
 	rf_Relation *rel = rf_relation_new_id(rf_set_new(4, elems));
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,1,2)] = true;
-	rel->table[rf_table_idx(rel,3,0)] = true;
-	rel->table[rf_table_idx(rel,3,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 1, 2, true);
+	rf_relation_set(rel, 3, 0, true);
+	rf_relation_set(rel, 3, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	bool result = rf_relation_is_lattice(rel, NULL);
 	CU_ASSERT_TRUE(result);
 
 	rf_Relation *relFalse = rf_relation_new_id(set);
 
-	relFalse->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,1,2)] = true;
+	rf_relation_set(relFalse, 0, 2, true);
+	rf_relation_set(rel, 1, 2, true);
 
 	result = rf_relation_is_lattice(relFalse, NULL);
 	CU_ASSERT_FALSE(result);
@@ -1401,27 +1896,35 @@ void test_rf_relation_make_difunctional(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	bool returnCode = rf_relation_make_difunctional(rel, true, NULL);
 
 	CU_ASSERT_TRUE(returnCode);
 
-	CU_ASSERT_TRUE(rel->table[rf_table_idx(rel,3,3)]);
+	CU_ASSERT_TRUE(rf_relation_get(rel, 3, 3));
 	CU_ASSERT_TRUE(rf_relation_is_difunctional(rel));
 
-	rel->table[rf_table_idx(rel,3,3)] = false;
+	//the least difunctional relation: rows 0 and 3 share column 2, nothing else joins
+	for(int x = 0; x < 4; x++) {
+		for(int y = 0; y < 4; y++) {
+			bool expected = ((x == 0 || x == 3) && y >= 2) || (x == 1 && y == 0) || (x == 2 && y == 1);
+			CU_ASSERT_EQUAL(rf_relation_get(rel, x, y), expected);
+		}
+	}
+
+	rf_relation_set(rel, 3, 3, false);
 
 	CU_ASSERT_FALSE(rf_relation_is_difunctional(rel));
 	returnCode = rf_relation_make_difunctional(rel, false, NULL);
 
 	CU_ASSERT_TRUE(returnCode);
 	CU_ASSERT_TRUE(rf_relation_is_difunctional(rel));
-	CU_ASSERT_FALSE(rel->table[rf_table_idx(rel,3,2)]);
+	CU_ASSERT_FALSE(rf_relation_get(rel, 3, 2));
 }
 
 void test_rf_relation_make_equivalent(){
@@ -1432,24 +1935,36 @@ void test_rf_relation_make_equivalent(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_equivalent(rel));
 
 	bool result = rf_relation_make_equivalent(rel, true, NULL);
 	CU_ASSERT_TRUE(result);
 	CU_ASSERT_TRUE(rf_relation_is_equivalent(rel));
+	CU_ASSERT_TRUE(rf_relation_get(rel, 3, 1));
+
+	//two classes and an element on its own
+	rf_Relation *classes = rf_relation_new_empty(mySet, mySet);
+	rf_relation_set(classes, 2, 0, true);
+	rf_relation_set(classes, 3, 3, true);
+	CU_ASSERT_TRUE(rf_relation_make_equivalent(classes, true, NULL));
+	CU_ASSERT_TRUE(rf_relation_get(classes, 0, 2));
+	CU_ASSERT_TRUE(rf_relation_get(classes, 1, 1));
+	CU_ASSERT_FALSE(rf_relation_get(classes, 0, 1));
+	CU_ASSERT_FALSE(rf_relation_get(classes, 3, 2));
+	rf_relation_free(classes);
 
 	rel = rf_relation_new_empty(mySet, mySet);
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_equivalent(rel));
 
@@ -1476,8 +1991,8 @@ void test_rf_relation_make_partial_order(){
 	CU_ASSERT_TRUE(rf_relation_is_partial_order(rel));
 
 	rel = rf_relation_new_id(set);
-	rel->table[rf_table_idx(rel, 0,1)] = true;
-	rel->table[rf_table_idx(rel, 2,2)] = false;
+	rf_relation_set(rel, 0, 1, true);
+	rf_relation_set(rel, 2, 2, false);
 	CU_ASSERT_FALSE(rf_relation_is_partial_order(rel));
 
 	rf_relation_make_partial_order(rel, true, NULL);
@@ -1492,11 +2007,11 @@ void test_rf_relation_make_preorder(){
 
 	rf_Relation *rel = rf_relation_new_empty(mySet, mySet);
 
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_preorder(rel));
 
@@ -1505,11 +2020,11 @@ void test_rf_relation_make_preorder(){
 	CU_ASSERT_TRUE(rf_relation_is_preorder(rel));
 
 	rel = rf_relation_new_empty(mySet, mySet);
-	rel->table[rf_table_idx(rel,0,2)] = true;
-	rel->table[rf_table_idx(rel,0,3)] = true;
-	rel->table[rf_table_idx(rel,1,0)] = true;
-	rel->table[rf_table_idx(rel,2,1)] = true;
-	rel->table[rf_table_idx(rel,3,2)] = true;
+	rf_relation_set(rel, 0, 2, true);
+	rf_relation_set(rel, 0, 3, true);
+	rf_relation_set(rel, 1, 0, true);
+	rf_relation_set(rel, 2, 1, true);
+	rf_relation_set(rel, 3, 2, true);
 
 	CU_ASSERT_FALSE(rf_relation_is_preorder(rel));
 
@@ -1561,15 +2076,18 @@ register_suites_relation() {
 		{ "rf_relation_new", test_rf_relation_new },
 		{ "rf_relation_clone", test_rf_relation_clone },
 		{ "rf_relation_new_id", test_rf_relation_new_id },
-		{ "rf_table_idx", test_rf_table_idx },
+		{ "rf_relation_new_wide", test_rf_relation_new_wide },
+		{ "rf_relation_row", test_rf_relation_row },
 		{ "rf_relation_calc", test_rf_relation_calc },
 		{ "rf_relation_new_top", test_rf_relation_new_top },
 		{ "rf_relation_new_bottom", test_rf_relation_new_bottom },
 		{ "rf_relation_new_union", test_rf_relation_new_union },
 		{ "rf_relation_new_intersection", test_rf_relation_new_intersection },
 		{ "rf_relation_new_complement", test_rf_relation_new_complement },
+		{ "rf_relation_make_union/intersection/complement", test_rf_relation_make_union_intersection_complement },
 		{ "rf_relation_new_concatenation", test_rf_relation_new_concatenation },
 		{ "rf_relation_new_converse", test_rf_relation_new_converse },
+		{ "rf_relation_make_converse", test_rf_relation_make_converse },
 		{ "rf_relation_new_subsetleq", test_rf_relation_new_subsetleq },
 		CU_TEST_INFO_NULL
 	};
@@ -1584,6 +2102,7 @@ register_suites_relation() {
 		{ "rf_relation_find_supremum", test_rf_relation_find_supremum },
 		{ "rf_relation_find_lowerbound", test_rf_relation_find_lowerbound },
 		{ "rf_relation_find_infimum", test_rf_relation_find_infimum },
+		{ "rf_relation_index_queries", test_rf_relation_index_queries },
 		{ "rf_relation_find_transitive_gaps", test_rf_relation_find_transitive_gaps },
 		{ "rf_relation_guess_transitive_core", test_rf_relation_guess_transitive_core },
 		{ "rf_relation_find_transitive_hard_core", test_rf_relation_find_transitive_hard_core },
@@ -1601,6 +2120,11 @@ register_suites_relation() {
 		{ "rf_relation_is_difcuntional", test_rf_relation_is_difunctional },
 		{ "rf_relation_is_equivalent", test_rf_relation_is_equivalent },
 		{ "rf_relation_is_symmetric", test_rf_relation_is_symmetric },
+		{ "rf_relation_properties", test_rf_relation_properties },
+		{ "rf_relation_property_cache", test_rf_relation_property_cache },
+		{ "rf_relation_track", test_rf_relation_track },
+		{ "rf_relation_witness", test_rf_relation_witness },
+		{ "rf_relation_count_violations", test_rf_relation_count_violations },
 		{ "rf_relation_is_irreflexive", test_rf_relation_is_irreflexive },
 		{ "rf_relation_is_reflexive", test_rf_relation_is_reflexive },
 		{ "rf_relation_is_partial_order", test_rf_relation_is_partial_order },
@@ -18,10 +18,14 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include <CUnit/CUnit.h>
 
 #include "set.h"
+#include "test_fixtures.h"
 
 void test_rf_set_new() {
 	char a[] = "a";
@@ -197,6 +201,253 @@ void test_rf_set_get_element_index() {
 	rf_set_element_free(test2);
 }
 
+void test_rf_set_get_element_index_hashed() {
+	//large enough for the hash index, with a duplicate of "e7" at the end
+	const int n = 100;
+	rf_SetElement *elems[n + 1];
+	generateNumberedElements(n, elems);
+	elems[n] = rf_set_element_new_string("e7");
+
+	rf_Set *set = rf_set_new(n + 1, elems);
+
+	for(int i = 0; i < n; i++) {
+		if(i != 7)
+			CU_ASSERT_EQUAL(rf_set_get_element_index(set, elems[i]), i);
+	}
+	CU_ASSERT_PTR_NOT_NULL(set->index);
+
+	//the last of equal members, like the linear scan
+	CU_ASSERT_EQUAL(rf_set_get_element_index(set, elems[7]), n);
+
+	rf_SetElement *missing = rf_set_element_new_string("e100");
+	CU_ASSERT_EQUAL(rf_set_get_element_index(set, missing), -1);
+
+	//members replaced in place are found after rf_set_invalidate
+	rf_set_element_free(set->elements[3]);
+	set->elements[3] = missing;
+	rf_set_invalidate(set);
+	CU_ASSERT_EQUAL(rf_set_get_element_index(set, missing), 3);
+
+	//a shorter set is noticed without
+	set->cardinality = 50;
+	CU_ASSERT_EQUAL(rf_set_get_element_index(set, elems[60]), -1);
+	set->cardinality = n + 1;
+
+	rf_set_free(set);
+}
+
+#define LOOKUP_THREADS  4
+
+static void *
+look_up_members(void *arg) {
+	const rf_Set *set = arg;
+	intptr_t misses = 0;
+	for(int i = set->cardinality-1; i >= 0; --i) {
+		if(rf_set_get_element_index(set, set->elements[i]) != i)
+			misses++;
+	}
+
+	return (void *) misses;
+}
+
+void test_rf_set_get_element_index_threads() {
+	//the threads race to build the index, all of them must find every member
+	rf_Set *set = generateNumberedSet(5000);
+
+	pthread_t threads[LOOKUP_THREADS];
+	for(int t = 0; t < LOOKUP_THREADS; t++)
+		pthread_create(&threads[t], NULL, look_up_members, set);
+	for(int t = 0; t < LOOKUP_THREADS; t++) {
+		void *misses;
+		pthread_join(threads[t], &misses);
+		CU_ASSERT_EQUAL((intptr_t) misses, 0);
+	}
+	CU_ASSERT_PTR_NOT_NULL(set->index);
+
+	rf_set_free(set);
+}
+
+void test_rf_set_element_hash() {
+	char a[] = "a";
+	char b[] = "b";
+	rf_SetElement *ab[] = { rf_set_element_new_string(a), rf_set_element_new_string(b) };
+	rf_SetElement *ba[] = { rf_set_element_new_string(b), rf_set_element_new_string(a) };
+	rf_Set *set_ab = rf_set_new(2, ab);
+	rf_Set *set_ba = rf_set_new(2, ba);
+	rf_SetElement *e1 = rf_set_element_new_set(set_ab);
+	rf_SetElement *e2 = rf_set_element_new_set(set_ba);
+
+	//equal elements hash equal, whatever the order of members
+	CU_ASSERT_TRUE(rf_set_element_equal(e1, e2));
+	CU_ASSERT_EQUAL(rf_set_element_hash(e1), rf_set_element_hash(e2));
+	CU_ASSERT_EQUAL(rf_set_element_hash(ab[0]), rf_set_element_hash(ba[1]));
+	CU_ASSERT_NOT_EQUAL(rf_set_element_hash(ab[0]), rf_set_element_hash(ab[1]));
+
+	rf_set_element_free(e1);
+	rf_set_element_free(e2);
+	rf_set_free(set_ab);
+	rf_set_free(set_ba);
+}
+
+void test_rf_set_element_key() {
+	char a[] = "a";
+	char b[] = "b";
+	char empty[] = "";
+	rf_SetElement *ab[] = { rf_set_element_new_string(a), rf_set_element_new_string(b) };
+	rf_SetElement *ba[] = { rf_set_element_new_string(b), rf_set_element_new_string(a) };
+	rf_Set *set_ab = rf_set_new(2, ab);
+	rf_Set *set_ba = rf_set_new(2, ba);
+	rf_Set *set_a = rf_set_new(1, (rf_SetElement *[]) { rf_set_element_new_string(a) });
+	rf_SetElement *e1 = rf_set_element_new_set(set_ab);
+	rf_SetElement *e2 = rf_set_element_new_set(set_ba);
+	rf_SetElement *e3 = rf_set_element_new_set(set_a);
+	rf_SetElement *e4 = rf_set_element_clone(e1);
+
+	//equal values share their key, each set keeps its order
+	CU_ASSERT_PTR_EQUAL(e1->key, e2->key);
+	CU_ASSERT_PTR_EQUAL(e1->key, e4->key);
+	CU_ASSERT_PTR_NOT_EQUAL(e1->key, e3->key);
+	CU_ASSERT_PTR_EQUAL(e1->value.set->elements[0]->key, ab[0]->key);
+	CU_ASSERT_PTR_EQUAL(e2->value.set->elements[0]->key, ba[0]->key);
+	CU_ASSERT_PTR_EQUAL(e4->value.set->elements[0]->key, ab[0]->key);
+
+	//nested one level deeper
+	rf_Set *outer1 = rf_set_new(2, (rf_SetElement *[]) { e1, e3 });
+	rf_Set *outer2 = rf_set_new(2, (rf_SetElement *[]) { rf_set_element_clone(e3), e2 });
+	rf_SetElement *f1 = rf_set_element_new_set(outer1);
+	rf_SetElement *f2 = rf_set_element_new_set(outer2);
+	CU_ASSERT_TRUE(rf_set_element_equal(f1, f2));
+	CU_ASSERT_PTR_EQUAL(f1->key, f2->key);
+	CU_ASSERT_TRUE(rf_set_contains_element(outer2, e4));
+
+	//the empty set is not the empty string
+	rf_Set *none = rf_set_new(0, NULL);
+	rf_SetElement *g1 = rf_set_element_new_set(none);
+	rf_SetElement *g2 = rf_set_element_new_string(empty);
+	CU_ASSERT_FALSE(rf_set_element_equal(g1, g2));
+	CU_ASSERT_PTR_NOT_EQUAL(g1->key, g2->key);
+
+	rf_set_element_free(e4);
+	rf_set_element_free(f1);
+	rf_set_element_free(f2);
+	rf_set_element_free(g1);
+	rf_set_element_free(g2);
+	rf_set_free(outer1);
+	rf_set_free(outer2);
+	rf_set_free(none);
+	rf_set_free(set_ab);
+	rf_set_free(set_ba);
+	rf_set_free(set_a);
+}
+
+static rf_Set *
+new_numbered_set(int from, int to, int step, bool sorted) {
+	rf_SetElement *elements[(to - from) / step + 1];
+	char buf[16];
+
+	int n = 0;
+	for(int i = from; i < to; i += step) {
+		snprintf(buf, sizeof(buf), "e%05d", i);
+		elements[n++] = rf_set_element_new_string(buf);
+	}
+
+	return sorted ? rf_set_new_sorted(n, elements) : rf_set_new(n, elements);
+}
+
+void test_rf_set_new_sorted() {
+	char a[] = "a";
+	char b[] = "b";
+	char c[] = "c";
+	rf_SetElement *elems[] = {
+		rf_set_element_new_string(c),
+		rf_set_element_new_string(a),
+		rf_set_element_new_string(b),
+		rf_set_element_new_string(a),
+	};
+
+	//canonical order, the duplicate is gone
+	rf_Set *set = rf_set_new_sorted(4, elems);
+	CU_ASSERT_TRUE(set->sorted);
+	CU_ASSERT_EQUAL(set->cardinality, 3);
+	CU_ASSERT_STRING_EQUAL(set->elements[0]->value.string, a);
+	CU_ASSERT_STRING_EQUAL(set->elements[1]->value.string, b);
+	CU_ASSERT_STRING_EQUAL(set->elements[2]->value.string, c);
+
+	//strings come before sets, sets order by cardinality first
+	rf_Set *clone = rf_set_clone(set);
+	CU_ASSERT_TRUE(clone->sorted);
+	rf_Set *empty = rf_set_new_sorted(0, NULL);
+	rf_SetElement *nested[] = {
+		rf_set_element_new_set(set),
+		rf_set_element_new_string(c),
+		rf_set_element_new_set(empty),
+	};
+	rf_Set *mixed = rf_set_new_sorted(3, nested);
+	CU_ASSERT_EQUAL(mixed->elements[0]->type, RF_SET_ELEMENT_TYPE_STRING);
+	CU_ASSERT_EQUAL(mixed->elements[1]->value.set->cardinality, 0);
+	CU_ASSERT_TRUE(rf_set_equal(mixed->elements[2]->value.set, clone));
+
+	rf_set_free(mixed);
+	rf_set_free(empty);
+	rf_set_free(clone);
+	rf_set_free(set);
+}
+
+void test_rf_set_merge() {
+	//multiples of 2 and of 3 below 600, sorted and not
+	rf_Set *twos = new_numbered_set(0, 600, 2, true);
+	rf_Set *threes = new_numbered_set(0, 600, 3, true);
+	rf_Set *twos_unsorted = new_numbered_set(0, 600, 2, false);
+	rf_Set *threes_unsorted = new_numbered_set(0, 600, 3, false);
+
+	rf_Set *both = rf_set_new_intersection(twos, threes);
+	rf_Set *either = rf_set_new_union(twos, threes);
+	rf_Set *only = rf_set_new_difference(twos, threes);
+	CU_ASSERT_TRUE(both->sorted);
+	CU_ASSERT_EQUAL(both->cardinality, 100);
+	CU_ASSERT_EQUAL(either->cardinality, 400);
+	CU_ASSERT_EQUAL(only->cardinality, 200);
+	for(int i = 1; i < either->cardinality; i++)
+		CU_ASSERT_TRUE(rf_set_element_compare(either->elements[i-1], either->elements[i]) < 0);
+
+	//the same sets without the canonical order
+	rf_Set *both_unsorted = rf_set_new_intersection(twos_unsorted, threes_unsorted);
+	rf_Set *either_unsorted = rf_set_new_union(twos_unsorted, threes_unsorted);
+	rf_Set *only_unsorted = rf_set_new_difference(twos_unsorted, threes);
+	CU_ASSERT_FALSE(both_unsorted->sorted);
+	CU_ASSERT_TRUE(rf_set_equal(both, both_unsorted));
+	CU_ASSERT_TRUE(rf_set_equal(either, either_unsorted));
+	CU_ASSERT_TRUE(rf_set_equal(only, only_unsorted));
+	CU_ASSERT_EQUAL(rf_set_compare(either, either_unsorted), 0);
+
+	CU_ASSERT_TRUE(rf_set_is_subset(both, twos));
+	CU_ASSERT_TRUE(rf_set_is_subset(both, threes_unsorted));
+	CU_ASSERT_FALSE(rf_set_is_subset(only, threes));
+	CU_ASSERT_FALSE(rf_set_equal(twos, either));
+
+	//very unbalanced sizes gallop
+	rf_Set *few = new_numbered_set(0, 600, 125, true);
+	rf_Set *all = new_numbered_set(0, 600, 1, true);
+	rf_Set *few_both = rf_set_new_intersection(all, few);
+	CU_ASSERT_EQUAL(few_both->cardinality, 5);
+	CU_ASSERT_TRUE(rf_set_is_subset(few, all));
+	CU_ASSERT_FALSE(rf_set_is_subset(few, threes));
+
+	rf_set_free(few_both);
+	rf_set_free(all);
+	rf_set_free(few);
+	rf_set_free(only_unsorted);
+	rf_set_free(either_unsorted);
+	rf_set_free(both_unsorted);
+	rf_set_free(only);
+	rf_set_free(either);
+	rf_set_free(both);
+	rf_set_free(threes_unsorted);
+	rf_set_free(twos_unsorted);
+	rf_set_free(threes);
+	rf_set_free(twos);
+}
+
 void test_rf_set_new_powerset() {
 CU_FAIL_FATAL("not implemented");
 	char a[] = "a";
@@ -429,6 +680,10 @@ register_suites_set() {
 		{ "rf_set_equal", test_rf_set_equal },
 		{ "rf_set_contains_element", test_rf_set_contains_element },
 		{ "rf_get_element_index", test_rf_set_get_element_index },
+		{ "rf_set_get_element_index_hashed", test_rf_set_get_element_index_hashed },
+		{ "rf_set_get_element_index_threads", test_rf_set_get_element_index_threads },
+		{ "rf_set_new_sorted", test_rf_set_new_sorted },
+		{ "rf_set_merge", test_rf_set_merge },
 		{ "rf_set_is_subset", test_rf_set_is_subset },
 		CU_TEST_INFO_NULL
 	};
@@ -438,6 +693,8 @@ register_suites_set() {
 		{ "rf_set_element_new_set", test_rf_set_element_new_set },
 		{ "rf_set_element_clone", test_rf_set_element_clone },
 		{ "rf_set_element_equal", test_rf_set_element_equal },
+		{ "rf_set_element_hash", test_rf_set_element_hash },
+		{ "rf_set_element_key", test_rf_set_element_key },
 		CU_TEST_INFO_NULL
 	};
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <CUnit/CUnit.h>
+
+#include "sparse_relation.h"
+#include "bitmatrix.h"
+#include "test_fixtures.h"
+
+void
+test_rf_sparse_relation_new() {
+	rf_Set *set = generateNumberedSet(4);
+	int x[] = { 2, 0, 2, 2, 3 };
+	int y[] = { 1, 3, 0, 1, 3 };
+
+	rf_SparseRelation *r = rf_sparse_relation_new(set, set, 5, x, y);
+	CU_ASSERT_EQUAL(rf_sparse_relation_count(r), 4);
+	CU_ASSERT_TRUE(rf_sparse_relation_get(r, 0, 3));
+	CU_ASSERT_TRUE(rf_sparse_relation_get(r, 2, 0));
+	CU_ASSERT_TRUE(rf_sparse_relation_get(r, 2, 1));
+	CU_ASSERT_TRUE(rf_sparse_relation_get(r, 3, 3));
+	CU_ASSERT_FALSE(rf_sparse_relation_get(r, 1, 1));
+	CU_ASSERT_FALSE(rf_sparse_relation_get(r, 3, 0));
+
+	//rows are sorted
+	CU_ASSERT_EQUAL(r->targets[r->offsets[2]], 0);
+	CU_ASSERT_EQUAL(r->targets[r->offsets[2] + 1], 1);
+
+	//round trip through the bit table
+	rf_Relation *dense = rf_sparse_relation_to_relation(r);
+	rf_SparseRelation *back = rf_sparse_relation_new_from_relation(dense);
+	CU_ASSERT_EQUAL(rf_sparse_relation_count(back), 4);
+	for(int i = 0; i < 4; i++) {
+		for(int j = 0; j < 4; j++) {
+			CU_ASSERT_EQUAL(rf_relation_get(dense, i, j), rf_sparse_relation_get(r, i, j));
+			CU_ASSERT_EQUAL(rf_sparse_relation_get(back, i, j), rf_sparse_relation_get(r, i, j));
+		}
+	}
+
+	rf_sparse_relation_free(back);
+	rf_relation_free(dense);
+	rf_sparse_relation_free(r);
+	rf_set_free(set);
+}
+
+void
+test_rf_sparse_relation_new_closure() {
+	/*
+	 * cycle 0 -> 1 -> 2 -> 0, leaving it 2 -> 3 -> 4, a loop 5 -> 5, 6 -> 0,
+	 * 7 on its own
+	 */
+	rf_Set *set = generateNumberedSet(8);
+	int x[] = { 0, 1, 2, 2, 3, 5, 6 };
+	int y[] = { 1, 2, 0, 3, 4, 5, 0 };
+	rf_SparseRelation *r = rf_sparse_relation_new(set, set, 7, x, y);
+
+	rf_SparseRelation *closure = rf_sparse_relation_new_closure(r, NULL);
+	CU_ASSERT_PTR_NOT_NULL(closure);
+
+	rf_Relation *expected = rf_sparse_relation_to_relation(r);
+	rf_bitmatrix_closure(expected->table, expected->stride, 8);
+	for(int i = 0; i < 8; i++) {
+		for(int j = 0; j < 8; j++) {
+			CU_ASSERT_EQUAL(rf_sparse_relation_get(closure, i, j), rf_relation_get(expected, i, j));
+		}
+	}
+	CU_ASSERT_TRUE(rf_sparse_relation_get(closure, 1, 1));
+	CU_ASSERT_TRUE(rf_sparse_relation_get(closure, 6, 4));
+	CU_ASSERT_FALSE(rf_sparse_relation_get(closure, 3, 3));
+	CU_ASSERT_FALSE(rf_sparse_relation_get(closure, 6, 6));
+	CU_ASSERT_EQUAL(rf_sparse_relation_count(closure), 3 * 5 + 1 + 1 + 5);
+
+	//heterogeneous relations have no closure
+	rf_Set *other = generateNumberedSet(3);
+	rf_SparseRelation *hetero = rf_sparse_relation_new(set, other, 0, NULL, NULL);
+	rf_Error error;
+	CU_ASSERT_PTR_NULL(rf_sparse_relation_new_closure(hetero, &error));
+
+	rf_sparse_relation_free(hetero);
+	rf_set_free(other);
+	rf_relation_free(expected);
+	rf_sparse_relation_free(closure);
+	rf_sparse_relation_free(r);
+	rf_set_free(set);
+}
+
+void
+test_rf_sparse_relation_close_relation() {
+	//a long chain takes the sparse path of make_transitive
+	int n = 1000;
+	rf_Set *set = generateNumberedSet(n);
+	rf_Relation *chain = rf_relation_new_empty(set, set);
+	for(int i = 1; i < n; i++)
+		rf_relation_set(chain, i, i-1, true);
+	rf_relation_set(chain, 500, 700, true);
+
+	CU_ASSERT_TRUE(rf_relation_make_transitive(chain, true, NULL));
+	for(int i = 0; i < n; i++) {
+		for(int j = 0; j < n; j++) {
+			bool expected = j < i || (i >= 500 && i <= 700 && j <= 700);
+			CU_ASSERT_EQUAL(rf_relation_get(chain, i, j), expected);
+		}
+	}
+
+	rf_relation_free(chain);
+	rf_set_free(set);
+}
+
+
+CU_ErrorCode
+register_suites_sparse_relation() {
+	CU_TestInfo sparse_relation_suite[] = {
+		{ "rf_sparse_relation_new", test_rf_sparse_relation_new },
+		{ "rf_sparse_relation_new_closure", test_rf_sparse_relation_new_closure },
+		{ "rf_sparse_relation_close_relation", test_rf_sparse_relation_close_relation },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Sparse relation", NULL, NULL, sparse_relation_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
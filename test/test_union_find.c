@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2013, Sebastian Pospiech
+ *
+ * This file is part of RelaFix.
+ *
+ * RelaFix is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RelaFix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU Lesser Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser Public License
+ * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <CUnit/CUnit.h>
+
+#include "union_find.h"
+
+void
+test_rf_union_find_union() {
+	rf_UnionFind *uf = rf_union_find_new(6);
+	for(int i = 0; i < 6; i++)
+		CU_ASSERT_EQUAL(rf_union_find_find(uf, i), i);
+
+	CU_ASSERT_TRUE(rf_union_find_union(uf, 0, 1));
+	CU_ASSERT_TRUE(rf_union_find_union(uf, 2, 3));
+	CU_ASSERT_TRUE(rf_union_find_union(uf, 3, 1));
+	CU_ASSERT_FALSE(rf_union_find_union(uf, 0, 2));
+
+	const int root = rf_union_find_find(uf, 0);
+	CU_ASSERT_EQUAL(rf_union_find_find(uf, 1), root);
+	CU_ASSERT_EQUAL(rf_union_find_find(uf, 2), root);
+	CU_ASSERT_EQUAL(rf_union_find_find(uf, 3), root);
+	CU_ASSERT_EQUAL(uf->size[root], 4);
+	CU_ASSERT_NOT_EQUAL(rf_union_find_find(uf, 4), root);
+	CU_ASSERT_NOT_EQUAL(rf_union_find_find(uf, 4), rf_union_find_find(uf, 5));
+
+	rf_union_find_free(uf);
+}
+
+
+CU_ErrorCode
+register_suites_union_find() {
+	CU_TestInfo union_find_suite[] = {
+		{ "rf_union_find_union", test_rf_union_find_union },
+		CU_TEST_INFO_NULL,
+	};
+
+	CU_SuiteInfo suites[] = {
+		{ "Union find", NULL, NULL, union_find_suite },
+		CU_SUITE_INFO_NULL,
+	};
+
+	return CU_register_suites(suites);
+}
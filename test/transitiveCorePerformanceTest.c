@@ -17,11 +17,21 @@
  * along with RelaFix.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
 #include "CUnit/Basic.h"
 #include "error.c"
+#include "bitrow.c"
+#include "index_set.c"
+#include "bitmatrix.c"
+#include "sparse_relation.c"
+#include "union_find.c"
+#include "poset.c"
+#include "arena.c"
+#include "atom.c"
 #include "set.c"
 #include "relation.c"
 
@@ -48,8 +58,8 @@ void test_rf_relation_guess_transitive_core() {
 		rf_Relation *bigRel = rf_relation_new_empty(bigSet, bigSet);
 
 		for(int i=0;i < testsize-1;i++) {
-			bigRel->table[rf_table_idx(bigRel, i, testsize-1)] = true;
-			bigRel->table[rf_table_idx(bigRel, testsize-1, i)] = true;
+			rf_relation_set(bigRel, i, testsize-1, true);
+			rf_relation_set(bigRel, testsize-1, i, true);
 		}
 		clock_t prgstart, prgende;
 		prgstart = clock();
@@ -62,7 +72,7 @@ void test_rf_relation_guess_transitive_core() {
 		for(int i = 0; i < testsize*testsize; i++) {
 			if(i%testsize == 0)
 				printf("\n");
-			printf("%i", bigRel->table[i]);
+			printf("%i", rf_relation_get(bigRel, i / testsize, i % testsize));
 		}
 		printf("\n");
 	}
@@ -80,8 +90,8 @@ void test_rf_relation_find_transitive_hard_core() {
 		rf_Relation *bigRel = rf_relation_new_empty(bigSet, bigSet);
 
 		for(int i = 0; i < testsize-1; i++) {
-			bigRel->table[rf_table_idx(bigRel, i,testsize-1)] = true;
-			bigRel->table[rf_table_idx(bigRel, testsize-1,i)] = true;
+			rf_relation_set(bigRel, i, testsize-1, true);
+			rf_relation_set(bigRel, testsize-1, i, true);
 		}
 		clock_t prgstart, prgende;
 		prgstart = clock();
@@ -94,13 +104,13 @@ void test_rf_relation_find_transitive_hard_core() {
 		for(int i = 0; i < testsize*testsize; i++) {
 			if(i%testsize == 0)
 				printf("\n");
-			printf("%i", result->table[i]);
+			printf("%i", rf_relation_get(result, i / testsize, i % testsize));
 		}
 		printf("\n");
 		int relationsCount = 0;
 		CU_ASSERT_TRUE(rf_relation_is_transitive(result));
 		for(int i = 0; i < testsize*testsize; i++) {
-			if(result->table[i])
+			if(rf_relation_get(result, i / testsize, i % testsize))
 				relationsCount++;
 		}
 		CU_ASSERT_EQUAL(testsize-1, relationsCount);